@@ -1,11 +1,84 @@
 #if !defined(DAISY_CONSTANTS_H)
 #define DAISY_CONSTANTS_H 1
 
-// Hypothetically the max number of channels that could be chained
-const float DAISY_DIVISOR = 16.f;
+// Max number of channel strips the master keeps per-strip state for
+const int DAISY_MAX_STRIPS = 256;
+
+// Number of scene slots on the master
+const int DAISY_SCENES = 8;
+
+// Automix power floor per strip, in volts squared, so silent strips share the gain evenly
+const float DAISY_AUTOMIX_FLOOR = 1e-4f;
+
+// Soft clip leaves levels up to this many volts untouched
+const float DAISY_SOFT_KNEE = 8.f;
+
+// What the modules decoding the bus do with levels beyond +/-12V. The bus
+// itself is plain float and never clips, however many strips are chained.
+enum DaisyHeadroom {
+    DAISY_HEADROOM_CLIP, // Hard clip at +/-12V, as the mixer always did
+    DAISY_HEADROOM_SOFT, // Linear up to the knee, then saturate smoothly into +/-12V
+    DAISY_HEADROOM_NONE, // Pass the bus level through untouched
+    DAISY_HEADROOM_COUNT
+};
+
+/** Applies a headroom policy to a voltage leaving the chain. */
+inline float daisyHeadroom(float v, int headroom) {
+    switch (headroom) {
+        case DAISY_HEADROOM_CLIP:
+            return clamp(v, -12.f, 12.f);
+        case DAISY_HEADROOM_SOFT: {
+            // Above the knee, a rational tanh approximation with unit slope at the knee
+            // and zero slope where it reaches 12V, at 3 times the knee's headroom (20V in)
+            float a = std::fabs(v);
+            if (a <= DAISY_SOFT_KNEE) {
+                return v;
+            }
+            float x = std::min((a - DAISY_SOFT_KNEE) / (12.f - DAISY_SOFT_KNEE), 3.f);
+            float y = DAISY_SOFT_KNEE + (12.f - DAISY_SOFT_KNEE) * x * (27.f + x * x) / (27.f + 9.f * x * x);
+            return v < 0.f ? -y : y;
+        }
+        default:
+            return v;
+    }
+}
+
+// What the strips and the master do with their automation lanes
+enum DaisyAutomationMode {
+    DAISY_AUTOMATION_OFF,
+    DAISY_AUTOMATION_PLAY,
+    DAISY_AUTOMATION_RECORD
+};
+
+// A channel strip's mix settings, as stored in a scene
+struct DaisyStripState {
+    float level = 1.f;
+    float pan = 0.f;
+    bool muted = false;
+};
+
+// Chain bookkeeping that modules other than strips pass along unchanged
+struct DaisyChainState {
+    // Number of channel strips upstream, used as the next strip's index
+    int strips = 0;
+
+    // One strip's current settings on the way to the master, -1 if none
+    int report_strip = -1;
+    DaisyStripState report;
+
+    // Peak envelope of the sidechain source strips upstream, in volts
+    float sidechain = 0.f;
+
+    // Summed smoothed power of the automix strips upstream, in volts squared
+    float automix_power = 0.f;
+    int automix_strips = 0;
+
+    // Voices on the cue bus, 0 while no strip upstream is cued and the bus isn't carried
+    int cue_channels = 0;
+};
 
 struct DaisyMessage {
-    // Daisy-chained mix signal
+    // Daisy-chained mix signal, summed at full level
     int channels = 1;
     float voltages_l[16] = {};
     float voltages_r[16] = {};
@@ -14,6 +87,54 @@ struct DaisyMessage {
     int single_channels = 1;
     float single_voltages_l[16] = {};
     float single_voltages_r[16] = {};
+
+    // Pre-fader listen bus, only valid for chain.cue_channels voices
+    float cue_l[16] = {};
+    float cue_r[16] = {};
+
+    DaisyChainState chain;
+};
+
+/** Copies the cue bus on to the right-side module, a no-op while nothing upstream is cued. */
+inline void daisyRelayCue(const DaisyChainState &chain, const DaisyMessage *from, DaisyMessage *to) {
+    for (int c = 0; c < chain.cue_channels; c++) {
+        to->cue_l[c] = from->cue_l[c];
+        to->cue_r[c] = from->cue_r[c];
+    }
+}
+
+// Sent from the master back up the chain, right to left
+struct DaisyReturnMessage {
+    // Strip that should report its settings, -1 if none
+    int report_strip = -1;
+
+    // One scene table entry on the way to its strip, -1 if none
+    int sync_strip = -1;
+    int sync_scene = 0;
+    bool sync_valid = false;
+    DaisyStripState sync;
+
+    // Scene morph position between scene_a and scene_b
+    bool scene_active = false;
+    int scene_a = 0;
+    int scene_b = 0;
+    float scene_morph = 0.f;
+
+    // Automation transport, the position is in clock ticks since the last reset
+    int automation = DAISY_AUTOMATION_OFF;
+    bool transport_running = false;
+    double transport_position = 0.0;
+
+    // Gain-sharing automix, the strips' total power as the master last saw it
+    bool automix = false;
+    float automix_power = 0.f;
+    int automix_strips = 0;
+
+    // Set by each module for its left neighbour: whether it reads the single voltages
+    bool needs_single = false;
+
+    // Set along with needs_single when an aux send on the left should send its aux bus, not its own signal
+    bool needs_aux = false;
 };
 
 #endif
@@ -0,0 +1,374 @@
+#include "QuantalAudioExtendedMixer.hpp"
+#include "Daisy.hpp"
+#include "DaisyGovernor.hpp"
+
+static const int ANALYZER_FFT_SIZE = 2048;
+static const int ANALYZER_SCOPE_POINTS = 512;
+static const int ANALYZER_MAX_COLUMNS = 256;
+
+// Display update rates, selectable from the context menu
+static const float ANALYZER_RATES[] = {15.f, 30.f, 60.f};
+
+struct DaisyAnalyzer : Module {
+    enum ParamIds {
+        NUM_PARAMS
+    };
+    enum InputIds {
+        NUM_INPUTS
+    };
+    enum OutputIds {
+        NUM_OUTPUTS
+    };
+    enum LightsIds {
+        LINK_LIGHT_L,
+        LINK_LIGHT_R,
+        NUM_LIGHTS
+    };
+
+    float link_l = 0.f;
+    float link_r = 0.f;
+    int updateRate = 1;
+
+    // Frames handed from the audio thread to the display, never analyzed here
+    dsp::RingBuffer<dsp::Frame<2>, 16384> frames;
+
+    dsp::ClockDivider lightDivider;
+
+    DaisyMessage daisyInputMessage[2][1];
+    DaisyReturnMessage daisyReturnMessage[2][1];
+
+    DaisyAnalyzer() {
+        config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+
+        configLight(LINK_LIGHT_L, "Daisy chain link input");
+        configLight(LINK_LIGHT_R, "Daisy chain link output");
+
+        // Set the expander messages
+        leftExpander.producerMessage = &daisyInputMessage[0];
+        leftExpander.consumerMessage = &daisyInputMessage[1];
+        rightExpander.producerMessage = &daisyReturnMessage[0];
+        rightExpander.consumerMessage = &daisyReturnMessage[1];
+
+        lightDivider.setDivision(512);
+    }
+
+    json_t *dataToJson() override {
+        json_t *rootJ = json_object();
+
+        // update rate
+        json_object_set_new(rootJ, "updateRate", json_integer(updateRate));
+
+        return rootJ;
+    }
+
+    void dataFromJson(json_t *rootJ) override {
+        // update rate
+        json_t *updateRateJ = json_object_get(rootJ, "updateRate");
+        if (updateRateJ)
+            updateRate = clamp((int)json_integer_value(updateRateJ), 0, 2);
+    }
+
+    void process(const ProcessArgs &args) override {
+        float daisySignals_l[16] = {};
+        float daisySignals_r[16] = {};
+        dsp::Frame<2> frame = {};
+        int chainChannels = 1;
+        DaisyChainState chainState;
+        DaisyReturnMessage returnMessage;
+
+        // Get daisy-chained data from left-side linked module
+        if (leftExpander.module && (
+            leftExpander.module->model == modelDaisyChannel2
+            || leftExpander.module->model == modelDaisyChannelVu
+            || leftExpander.module->model == modelDaisyChannelSends2
+            || leftExpander.module->model == modelDaisyChannelSends3
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyMaster2
+            || leftExpander.module->model == modelDaisyBlank1
+            || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
+        )) {
+            DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
+            chainChannels = msgFromModule->channels;
+            chainState = msgFromModule->chain;
+            for (int c = 0; c < chainChannels; c++) {
+                daisySignals_l[c] = msgFromModule->voltages_l[c];
+                daisySignals_r[c] = msgFromModule->voltages_r[c];
+            }
+
+            // Get the immediate signal from the linked module, summed to stereo
+            for (int c = 0; c < msgFromModule->single_channels; c++) {
+                frame.samples[0] += msgFromModule->single_voltages_l[c];
+                frame.samples[1] += msgFromModule->single_voltages_r[c];
+            }
+
+            link_l = 0.8f;
+        } else {
+            link_l = 0.0f;
+        }
+
+        // Frames are dropped while the display isn't keeping up
+        if (!frames.full()) {
+            frames.push(frame);
+        }
+
+        // Set daisy-chained output to right-side linked module
+        if (rightExpander.module && (
+            rightExpander.module->model == modelDaisyMaster2
+            || rightExpander.module->model == modelDaisyChannel2
+            || rightExpander.module->model == modelDaisyChannelVu
+            || rightExpander.module->model == modelDaisyChannelSends2
+            || rightExpander.module->model == modelDaisyChannelSends3
+            || rightExpander.module->model == modelDaisyChannelDynamics
+            || rightExpander.module->model == modelDaisyAnalyzer
+            || rightExpander.module->model == modelDaisyBlank1
+            || rightExpander.module->model == modelDaisyBlank2
+            || rightExpander.module->model == modelDaisyReverb
+            || rightExpander.module->model == modelDaisyMatrix
+        )) {
+            DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
+
+            msgToModule->channels = chainChannels;
+            msgToModule->chain = chainState;
+            daisyRelayCue(chainState, (DaisyMessage *)(leftExpander.consumerMessage), msgToModule);
+
+            // Get the return message coming back from the master
+            returnMessage = *(DaisyReturnMessage *)(rightExpander.consumerMessage);
+
+            for (int c = 0; c < chainChannels; c++) {
+                msgToModule->voltages_l[c] = daisySignals_l[c];
+                msgToModule->voltages_r[c] = daisySignals_r[c];
+            }
+
+            rightExpander.module->leftExpander.messageFlipRequested = true;
+
+            link_r = 0.8f;
+        } else {
+            link_r = 0.0f;
+        }
+
+        // Pass the return message on to the left-side linked module, with this module's demand for single voltages
+        if (link_l > 0.f && leftExpander.module->model != modelDaisyMaster2) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            returnToModule->needs_single = true;
+            returnToModule->needs_aux = false;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
+
+        // Set lights
+        if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
+            lights[LINK_LIGHT_L].setBrightness(link_l);
+            lights[LINK_LIGHT_R].setBrightness(link_r);
+        }
+    }
+};
+
+/** Spectrum, phase correlation and goniometer, analyzed on the UI thread. */
+struct DaisyAnalyzerDisplay : widget::Widget {
+    DaisyAnalyzer *module = nullptr;
+
+    // Latest frames pulled from the module's ring buffer
+    float history_l[ANALYZER_FFT_SIZE] = {};
+    float history_r[ANALYZER_FFT_SIZE] = {};
+    int historyPos = 0;
+
+    dsp::RealFFT fft {ANALYZER_FFT_SIZE};
+    alignas(16) float fftInput[ANALYZER_FFT_SIZE] = {};
+    alignas(16) float fftOutput[ANALYZER_FFT_SIZE] = {};
+    float window[ANALYZER_FFT_SIZE];
+
+    float spectrumDb[ANALYZER_MAX_COLUMNS];
+    float correlation = 0.f;
+    double lastUpdate = 0.0;
+
+    // Layout
+    math::Rect spectrumBox;
+    math::Rect correlationBox;
+    math::Rect scopeBox;
+
+    DaisyAnalyzerDisplay() {
+        for (int i = 0; i < ANALYZER_FFT_SIZE; i++) {
+            window[i] = 0.5f * (1.f - std::cos(2.f * M_PI * i / (ANALYZER_FFT_SIZE - 1)));
+        }
+        for (int i = 0; i < ANALYZER_MAX_COLUMNS; i++) {
+            spectrumDb[i] = -90.f;
+        }
+    }
+
+    void setLayout(math::Vec size) {
+        box.size = size;
+        spectrumBox = math::Rect(0.f, 0.f, size.x, 110.f);
+        correlationBox = math::Rect(0.f, 118.f, size.x, 10.f);
+        scopeBox = math::Rect(0.f, 136.f, size.x, size.y - 136.f);
+    }
+
+    void analyze() {
+        float sampleRate = APP->engine->getSampleRate();
+
+        // Mono spectrum of the latest window, 10V = 0 dB
+        float sumLR = 0.f;
+        float sumLL = 0.f;
+        float sumRR = 0.f;
+        for (int i = 0; i < ANALYZER_FFT_SIZE; i++) {
+            int j = (historyPos + i) % ANALYZER_FFT_SIZE;
+            float l = history_l[j];
+            float r = history_r[j];
+            fftInput[i] = 0.5f * (l + r) * window[i];
+            sumLR += l * r;
+            sumLL += l * l;
+            sumRR += r * r;
+        }
+        fft.rfft(fftInput, fftOutput);
+
+        int columns = std::min((int)spectrumBox.size.x, ANALYZER_MAX_COLUMNS);
+        float binHz = sampleRate / ANALYZER_FFT_SIZE;
+        float norm = 4.f / (ANALYZER_FFT_SIZE * 10.f);
+        for (int x = 0; x < columns; x++) {
+            // 20 Hz to 20 kHz on a log axis, taking the loudest bin under each column
+            int bin0 = (int)(20.f * std::pow(1000.f, (float)x / columns) / binHz);
+            int bin1 = (int)(20.f * std::pow(1000.f, (float)(x + 1) / columns) / binHz);
+            bin0 = clamp(bin0, 1, ANALYZER_FFT_SIZE / 2 - 1);
+            bin1 = clamp(bin1, bin0 + 1, ANALYZER_FFT_SIZE / 2);
+            float peak = 0.f;
+            for (int b = bin0; b < bin1; b++) {
+                float re = fftOutput[2 * b];
+                float im = fftOutput[2 * b + 1];
+                peak = std::max(peak, re * re + im * im);
+            }
+            float db = 10.f * std::log10(peak * norm * norm + 1e-12f);
+
+            // Fast rise, slow fall
+            spectrumDb[x] = std::max(db, spectrumDb[x] - 3.f);
+        }
+
+        float denominator = std::sqrt(sumLL * sumRR);
+        float newCorrelation = denominator > 1e-9f ? sumLR / denominator : 0.f;
+        correlation += 0.3f * (newCorrelation - correlation);
+    }
+
+    void step() override {
+        if (module) {
+            // Pull whatever the audio thread produced since the last frame
+            while (!module->frames.empty()) {
+                dsp::Frame<2> frame = module->frames.shift();
+                history_l[historyPos] = frame.samples[0];
+                history_r[historyPos] = frame.samples[1];
+                historyPos = (historyPos + 1) % ANALYZER_FFT_SIZE;
+            }
+
+            // The governor halves the analysis rate for each quality step it takes
+            double now = system::getTime();
+            float rate = ANALYZER_RATES[module->updateRate] / (1 << daisyGovernor.quality);
+            if (now - lastUpdate >= 1.0 / rate) {
+                lastUpdate = now;
+                analyze();
+            }
+        }
+        Widget::step();
+    }
+
+    void drawSpectrum(NVGcontext *vg) {
+        int columns = std::min((int)spectrumBox.size.x, ANALYZER_MAX_COLUMNS);
+        float bottom = spectrumBox.pos.y + spectrumBox.size.y;
+
+        nvgBeginPath(vg);
+        nvgMoveTo(vg, spectrumBox.pos.x, bottom);
+        for (int x = 0; x < columns; x++) {
+            float level = clamp(rescale(spectrumDb[x], -90.f, 0.f, 0.f, 1.f), 0.f, 1.f);
+            nvgLineTo(vg, spectrumBox.pos.x + x, bottom - level * spectrumBox.size.y);
+        }
+        nvgLineTo(vg, spectrumBox.pos.x + columns, bottom);
+        nvgFillColor(vg, nvgRGBA(0x19, 0x94, 0xb3, 0xc0));
+        nvgFill(vg);
+    }
+
+    void drawCorrelation(NVGcontext *vg) {
+        const math::Rect &b = correlationBox;
+        float center = b.pos.x + b.size.x / 2.f;
+        float x = center + correlation * b.size.x / 2.f;
+
+        nvgBeginPath(vg);
+        nvgRect(vg, std::min(center, x), b.pos.y, std::fabs(x - center), b.size.y);
+        nvgFillColor(vg, correlation < 0.f ? nvgRGB(0xc9, 0x18, 0x47) : nvgRGB(0x55, 0xc0, 0x46));
+        nvgFill(vg);
+
+        nvgBeginPath(vg);
+        nvgMoveTo(vg, center, b.pos.y);
+        nvgLineTo(vg, center, b.pos.y + b.size.y);
+        nvgStrokeColor(vg, nvgRGBA(0xff, 0xff, 0xff, 0x80));
+        nvgStrokeWidth(vg, 1.f);
+        nvgStroke(vg);
+    }
+
+    void drawScope(NVGcontext *vg) {
+        const math::Rect &b = scopeBox;
+        float cx = b.pos.x + b.size.x / 2.f;
+        float cy = b.pos.y + b.size.y / 2.f;
+        float radius = std::min(b.size.x, b.size.y) / 2.f;
+
+        // Mid up, side across, 10V at the edge
+        nvgBeginPath(vg);
+        for (int i = 0; i < ANALYZER_SCOPE_POINTS; i++) {
+            int j = (historyPos - ANALYZER_SCOPE_POINTS + i + ANALYZER_FFT_SIZE) % ANALYZER_FFT_SIZE;
+            float side = clamp((history_l[j] - history_r[j]) * (float)M_SQRT1_2 / 10.f, -1.f, 1.f);
+            float mid = clamp((history_l[j] + history_r[j]) * (float)M_SQRT1_2 / 10.f, -1.f, 1.f);
+            float x = cx + side * radius;
+            float y = cy - mid * radius;
+            if (i == 0)
+                nvgMoveTo(vg, x, y);
+            else
+                nvgLineTo(vg, x, y);
+        }
+        nvgStrokeColor(vg, nvgRGBA(0x55, 0xc0, 0x46, 0xa0));
+        nvgStrokeWidth(vg, 0.7f);
+        nvgStroke(vg);
+    }
+
+    void drawLayer(const DrawArgs &args, int layer) override {
+        if (layer == 1 && module) {
+            nvgSave(args.vg);
+            nvgScissor(args.vg, 0.f, 0.f, box.size.x, box.size.y);
+            drawSpectrum(args.vg);
+            drawCorrelation(args.vg);
+            drawScope(args.vg);
+            nvgRestore(args.vg);
+        }
+        Widget::drawLayer(args, layer);
+    }
+};
+
+struct DaisyAnalyzerWidget : ModuleWidget {
+    DaisyAnalyzerWidget(DaisyAnalyzer *module) {
+        setModule(module);
+        setPanel(createPanel(asset::plugin(pluginInstance, "res/DaisyAnalyzer.svg"), asset::plugin(pluginInstance, "res/DaisyAnalyzer-dark.svg")));
+
+        // Screws
+        addChild(createWidget<ThemedScrew>(Vec(RACK_GRID_WIDTH, 0)));
+        addChild(createWidget<ThemedScrew>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, 0)));
+        addChild(createWidget<ThemedScrew>(Vec(RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+        addChild(createWidget<ThemedScrew>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+
+        // Display
+        DaisyAnalyzerDisplay *display = createWidget<DaisyAnalyzerDisplay>(Vec(9.0, 42.0));
+        display->module = module;
+        display->setLayout(Vec(box.size.x - 18.0, 250.0));
+        addChild(display);
+
+        // Link lights
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(box.size.x / 2 - 4, 361.0f), module, DaisyAnalyzer::LINK_LIGHT_L));
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(box.size.x / 2 + 4, 361.0f), module, DaisyAnalyzer::LINK_LIGHT_R));
+    }
+
+    void appendContextMenu(Menu *menu) override {
+        DaisyAnalyzer *module = dynamic_cast<DaisyAnalyzer *>(this->module);
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createIndexPtrSubmenuItem("Update rate", {"15 Hz", "30 Hz", "60 Hz"}, &module->updateRate));
+    }
+};
+
+Model *modelDaisyAnalyzer = createModel<DaisyAnalyzer, DaisyAnalyzerWidget>("DaisyAnalyzer");
@@ -0,0 +1,295 @@
+#if !defined(DAISY_AUTOMATION_H)
+#define DAISY_AUTOMATION_H 1
+
+// Max breakpoints per lane
+const int DAISY_AUTOMATION_POINTS = 4096;
+
+// Breakpoint positions are kept in 1/256ths of a clock tick
+const double DAISY_AUTOMATION_UNITS = 256.0;
+
+// Recorded samples are dropped while the line between the kept points passes this close to all of them
+const float DAISY_AUTOMATION_TOLERANCE = 1.f / 512.f;
+
+/**
+ * An automation lane of breakpoints, delta-encoded in preallocated memory.
+ * Values are normalized to 0..1 and interpolated linearly between points.
+ * Nothing here allocates, so lanes can be recorded and played back on the
+ * audio thread.
+ */
+struct DaisyAutomationLane {
+    struct Point {
+        // Distance from the previous point in 1/256 ticks, or the absolute position for the first point
+        uint32_t delta;
+        // Value scaled to 0..65535
+        uint16_t value;
+    };
+
+    Point points[DAISY_AUTOMATION_POINTS];
+    int size = 0;
+
+    // Absolute position of the last point
+    uint32_t end = 0;
+
+    // Playback cursor, the point before the read position
+    int cursor = 0;
+    uint32_t cursorPosition = 0;
+
+    // Set once a recording ran out of points and dropped moves
+    bool full = false;
+
+    // While recording, the old points after the punch-in wait at the back of
+    // the array and are joined back on after the punch-out
+    bool punched = false;
+    int tailSize = 0;
+    uint32_t tailStart = 0;
+    bool tailHasPrev = false;
+    uint32_t tailPrevPosition = 0;
+    uint16_t tailPrevValue = 0;
+
+    // Latest recorded sample, kept until a later one shows whether it is needed
+    bool pending = false;
+    uint32_t pendingPosition = 0;
+    float pendingValue = 0.f;
+
+    // Slopes from the last point that stay within tolerance of every dropped sample
+    float slopeLow = -INFINITY;
+    float slopeHigh = INFINITY;
+
+    static uint32_t toUnits(double position) {
+        // 32 bits hold about 46 hours of the free-running transport
+        return (uint32_t)std::min(std::max(position, 0.0) * DAISY_AUTOMATION_UNITS, (double)UINT32_MAX);
+    }
+
+    bool empty() const {
+        return size == 0;
+    }
+
+    void clear() {
+        size = 0;
+        end = 0;
+        cursor = 0;
+        cursorPosition = 0;
+        full = false;
+        punched = false;
+        tailSize = 0;
+        pending = false;
+    }
+
+    /** Returns the value at a position. Positions should move forward, except after a reset. */
+    float read(double position) {
+        return valueAt(toUnits(position));
+    }
+
+    float valueAt(uint32_t p) {
+        if (size == 0) {
+            return 0.f;
+        }
+
+        if (p < cursorPosition) {
+            cursor = 0;
+            cursorPosition = points[0].delta;
+        }
+        while (cursor + 1 < size && cursorPosition + points[cursor + 1].delta <= p) {
+            cursor++;
+            cursorPosition += points[cursor].delta;
+        }
+
+        float v0 = points[cursor].value / 65535.f;
+        if (cursor + 1 >= size || p <= cursorPosition) {
+            return v0;
+        }
+        float v1 = points[cursor + 1].value / 65535.f;
+        float t = (float)(p - cursorPosition) / points[cursor + 1].delta;
+        return v0 + (v1 - v0) * t;
+    }
+
+    /**
+     * Adds a sample while recording, keeping only the breakpoints needed to
+     * redraw the moves. Points between the punch-in and the punch-out are
+     * replaced, the rest of the lane is kept.
+     */
+    void record(double position, float value) {
+        uint32_t p = toUnits(position);
+        uint32_t last = pending ? pendingPosition : end;
+        if (punched && p < last) {
+            // The transport went back, punch in again from here
+            finishRecording();
+        } else if (punched && p == last) {
+            return;
+        }
+        if (!punched) {
+            punchIn(p, value);
+            append(p, value);
+            return;
+        }
+
+        float anchor = points[size - 1].value / 65535.f;
+        float slope = (value - anchor) / (float)(p - end);
+        if (pending) {
+            // The pending sample is dropped only if the line to the new one
+            // still passes every sample dropped since the last point
+            float dt = (float)(pendingPosition - end);
+            float low = std::max(slopeLow, (pendingValue - DAISY_AUTOMATION_TOLERANCE - anchor) / dt);
+            float high = std::min(slopeHigh, (pendingValue + DAISY_AUTOMATION_TOLERANCE - anchor) / dt);
+            if (slope >= low && slope <= high) {
+                slopeLow = low;
+                slopeHigh = high;
+            } else {
+                append(pendingPosition, pendingValue);
+            }
+        }
+        pending = true;
+        pendingPosition = p;
+        pendingValue = value;
+    }
+
+    /** Commits the last recorded sample and joins the rest of the old lane back on. */
+    void finishRecording() {
+        if (!punched) {
+            return;
+        }
+        if (pending) {
+            append(pendingPosition, pendingValue);
+            pending = false;
+        }
+
+        // Drop the old points up to the punch-out
+        int from = DAISY_AUTOMATION_POINTS - tailSize;
+        uint32_t at = tailStart;
+        while (tailSize > 0 && at <= end) {
+            tailHasPrev = true;
+            tailPrevPosition = at;
+            tailPrevValue = points[from].value;
+            from++;
+            tailSize--;
+            if (tailSize > 0) {
+                at += points[from].delta;
+            }
+        }
+
+        if (tailSize > 0) {
+            // Step back to where the old lane was at the punch-out
+            float next = points[from].value / 65535.f;
+            float old = next;
+            if (tailHasPrev) {
+                float prev = tailPrevValue / 65535.f;
+                float t = (float)(end - tailPrevPosition) / (at - tailPrevPosition);
+                old = prev + (next - prev) * t;
+            }
+            if (at - end > 1 && std::fabs(points[size - 1].value / 65535.f - old) > DAISY_AUTOMATION_TOLERANCE) {
+                append(end + 1, old);
+            }
+
+            int count = std::min(tailSize, DAISY_AUTOMATION_POINTS - size);
+            full |= count < tailSize;
+            std::memmove(&points[size], &points[from], count * sizeof(Point));
+            points[size].delta = at - end;
+            for (int i = 0; i < count; i++) {
+                end += points[size].delta;
+                size++;
+            }
+        }
+
+        punched = false;
+        tailSize = 0;
+        cursor = 0;
+        cursorPosition = size > 0 ? points[0].delta : 0;
+    }
+
+    /** Moves the points at or after a position out of the way of a new recording. */
+    void punchIn(uint32_t p, float value) {
+        uint32_t at = 0;
+        int keep = 0;
+        while (keep < size && at + points[keep].delta < p) {
+            at += points[keep].delta;
+            keep++;
+        }
+
+        float old = valueAt(p);
+        tailSize = size - keep;
+        tailStart = tailSize > 0 ? at + points[keep].delta : 0;
+        tailHasPrev = keep > 0;
+        tailPrevPosition = at;
+        tailPrevValue = keep > 0 ? points[keep - 1].value : 0;
+        std::memmove(&points[DAISY_AUTOMATION_POINTS - tailSize], &points[keep], tailSize * sizeof(Point));
+
+        size = keep;
+        end = keep > 0 ? at : 0;
+        punched = true;
+        pending = false;
+        cursor = 0;
+        cursorPosition = size > 0 ? points[0].delta : 0;
+
+        // Hold the old lane right up to the punch-in
+        if (size > 0 && p - end > 1 && std::fabs(value - old) > DAISY_AUTOMATION_TOLERANCE) {
+            append(p - 1, old);
+        }
+    }
+
+    void append(uint32_t p, float value) {
+        uint16_t v = (uint16_t)(clamp(value, 0.f, 1.f) * 65535.f + 0.5f);
+        // A full lane drops further moves and says so in the menu
+        if (size >= DAISY_AUTOMATION_POINTS - (punched ? tailSize : 0)) {
+            full = true;
+            return;
+        }
+        uint32_t delta = size > 0 ? p - end : p;
+        if (size == 0) {
+            cursor = 0;
+            cursorPosition = p;
+        }
+        points[size++] = {delta, v};
+        end = p;
+        slopeLow = -INFINITY;
+        slopeHigh = INFINITY;
+    }
+
+    // Saved as 6 little-endian bytes per point, delta then value
+    json_t *toJson() {
+        std::vector<Point> saved(points, points + size);
+        if (punched) {
+            // Saved mid-recording, keep the old points after the punch-out so far
+            uint32_t at = tailStart;
+            uint32_t last = end;
+            for (int i = DAISY_AUTOMATION_POINTS - tailSize; i < DAISY_AUTOMATION_POINTS; i++) {
+                if (i > DAISY_AUTOMATION_POINTS - tailSize) {
+                    at += points[i].delta;
+                }
+                if (at > last || saved.empty()) {
+                    saved.push_back({saved.empty() ? at : at - last, points[i].value});
+                    last = at;
+                }
+            }
+        }
+
+        std::vector<uint8_t> data(saved.size() * 6);
+        for (size_t i = 0; i < saved.size(); i++) {
+            uint8_t *d = &data[i * 6];
+            for (int b = 0; b < 4; b++) {
+                d[b] = (saved[i].delta >> (8 * b)) & 0xff;
+            }
+            d[4] = saved[i].value & 0xff;
+            d[5] = saved[i].value >> 8;
+        }
+        std::string encoded = string::toBase64(data.data(), data.size());
+        return json_string(encoded.c_str());
+    }
+
+    void fromJson(json_t *laneJ) {
+        clear();
+        if (!json_is_string(laneJ)) {
+            return;
+        }
+        std::vector<uint8_t> data = string::fromBase64(json_string_value(laneJ));
+        size = std::min((int)(data.size() / 6), DAISY_AUTOMATION_POINTS);
+        for (int i = 0; i < size; i++) {
+            const uint8_t *d = &data[i * 6];
+            points[i].delta = d[0] | (d[1] << 8) | (d[2] << 16) | ((uint32_t)d[3] << 24);
+            points[i].value = d[4] | (d[5] << 8);
+            end += points[i].delta;
+        }
+        cursorPosition = size > 0 ? points[0].delta : 0;
+    }
+};
+
+#endif
@@ -1,5 +1,7 @@
 #include "QuantalAudioExtendedMixer.hpp"
 #include "Daisy.hpp"
+#include "DaisyGovernor.hpp"
+#include "DaisyTrace.hpp"
 
 struct DaisyBlank2 : Module {
     enum ParamIds {
@@ -22,8 +24,11 @@ struct DaisyBlank2 : Module {
 
     dsp::ClockDivider lightDivider;
 
+    // Trace of the messages arriving from the left
+    DaisyTraceCapture trace;
+
     DaisyMessage daisyInputMessage[2][1];
-    DaisyMessage daisyOutputMessage[2][1];
+    DaisyReturnMessage daisyReturnMessage[2][1];
 
     DaisyBlank2() {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -34,8 +39,8 @@ struct DaisyBlank2 : Module {
         // Set the expander messages
         leftExpander.producerMessage = &daisyInputMessage[0];
         leftExpander.consumerMessage = &daisyInputMessage[1];
-        rightExpander.producerMessage = &daisyOutputMessage[0];
-        rightExpander.consumerMessage = &daisyOutputMessage[1];
+        rightExpander.producerMessage = &daisyReturnMessage[0];
+        rightExpander.consumerMessage = &daisyReturnMessage[1];
 
         lightDivider.setDivision(512);
     }
@@ -45,6 +50,8 @@ struct DaisyBlank2 : Module {
         float daisySignals_l[16] = {};
         float daisySignals_r[16] = {};
         int chainChannels = 1;
+        DaisyChainState chainState;
+        DaisyReturnMessage returnMessage;
 
         // Get daisy-chained data from left-side linked module
         if (leftExpander.module && (
@@ -55,9 +62,15 @@ struct DaisyBlank2 : Module {
             || leftExpander.module->model == modelDaisyMaster2
             || leftExpander.module->model == modelDaisyBlank1
             || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
+            trace.push(*msgFromModule, args.frame);
             chainChannels = msgFromModule->channels;
+            chainState = msgFromModule->chain;
             for (int c = 0; c < chainChannels; c++) {
                 daisySignals_l[c] = msgFromModule->voltages_l[c];
                 daisySignals_r[c] = msgFromModule->voltages_r[c];
@@ -77,10 +90,20 @@ struct DaisyBlank2 : Module {
             || rightExpander.module->model == modelDaisyChannelSends3
             || rightExpander.module->model == modelDaisyBlank1
             || rightExpander.module->model == modelDaisyBlank2
+            || rightExpander.module->model == modelDaisyChannelDynamics
+            || rightExpander.module->model == modelDaisyAnalyzer
+            || rightExpander.module->model == modelDaisyReverb
+            || rightExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
 
             msgToModule->channels = chainChannels;
+            msgToModule->chain = chainState;
+            daisyRelayCue(chainState, (DaisyMessage *)(leftExpander.consumerMessage), msgToModule);
+
+            // Get the return message coming back from the master
+            returnMessage = *(DaisyReturnMessage *)(rightExpander.consumerMessage);
+
             for (int c = 0; c < chainChannels; c++) {
                 msgToModule->voltages_l[c] = daisySignals_l[c];
                 msgToModule->voltages_r[c] = daisySignals_r[c];
@@ -93,8 +116,18 @@ struct DaisyBlank2 : Module {
             link_r = 0.0f;
         }
 
+        // Pass the return message on to the left-side linked module, with this module's demand for single voltages
+        if (link_l > 0.f && leftExpander.module->model != modelDaisyMaster2) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            returnToModule->needs_single = trace.isTracing();
+            returnToModule->needs_aux = false;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
+
         // Set lights
         if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
             lights[LINK_LIGHT_L].setBrightness(link_l);
             lights[LINK_LIGHT_R].setBrightness(link_r);
         }
@@ -114,6 +147,12 @@ struct DaisyBlank2Widget : ModuleWidget {
         addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH - 4, 361.0f), module, DaisyBlank2::LINK_LIGHT_L));
         addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH + 4, 361.0f), module, DaisyBlank2::LINK_LIGHT_R));
     }
+
+    void appendContextMenu(Menu *menu) override {
+        DaisyBlank2 *module = dynamic_cast<DaisyBlank2 *>(this->module);
+
+        daisyAppendTraceMenu(menu, &module->trace);
+    }
 };
 
 Model *modelDaisyBlank2 = createModel<DaisyBlank2, DaisyBlank2Widget>("DaisyBlank2");
@@ -1,11 +1,20 @@
 #include "QuantalAudioExtendedMixer.hpp"
 #include "Daisy.hpp"
+#include "DaisyAutomation.hpp"
+#include "DaisyDelay.hpp"
+#include "DaisyMath.hpp"
+#include "DaisyGovernor.hpp"
 
 struct DaisyChannel2 : Module {
     enum ParamIds {
         CH_LVL_PARAM,
         MUTE_PARAM,
         PAN_PARAM,
+        DUCK_DEPTH_PARAM,
+        DUCK_RELEASE_PARAM,
+        DELAY_PARAM,
+        HAAS_PARAM,
+        CUE_PARAM,
         NUM_PARAMS
     };
     enum InputIds {
@@ -23,22 +32,77 @@ struct DaisyChannel2 : Module {
         MUTE_LIGHT,
         LINK_LIGHT_L,
         LINK_LIGHT_R,
+        CUE_LIGHT,
         NUM_LIGHTS
     };
 
     bool muted = false;
+    bool cued = false;
     float link_l = 0.f;
     float link_r = 0.f;
     dsp::ClockDivider lightDivider;
+    dsp::ClockDivider controlDivider;
+
+    // Position in the chain and this strip's part of the master's scenes
+    int stripIndex = 0;
+    DaisyStripState scenes[DAISY_SCENES];
+    bool sceneValid[DAISY_SCENES] = {};
+    DaisyStripState sceneApplied;
+    bool sceneWasActive = false;
+
+    // Automation lanes for level, pan and mute, recorded while armed
+    enum AutomationLanes {
+        LEVEL_LANE,
+        PAN_LANE,
+        MUTE_LANE,
+        NUM_LANES
+    };
+    DaisyAutomationLane lanes[NUM_LANES];
+    bool automationArmed = true;
+    bool automationRecording = false;
+    std::atomic<bool> clearAutomation {false};
+
+    // Sidechain source detector, sampled once per control block
+    bool sidechainSource = false;
+    float sidechainPeak = 0.f;
+    float sidechainEnvelope = 0.f;
+
+    // Ducking against the sidechain sources upstream, ramped per sample
+    float sidechainIn = 0.f;
+    float duckGain = 1.f;
+    float duckStep = 0.f;
+    float duckTarget = 1.f;
+    int duckSteps = 0;
+
+    // Gain-sharing automix: this strip's power, smoothed per control block, and its share of the total
+    bool automixEnabled = true;
+    bool automixActive = false;
+    float automixSum = 0.f;
+    float automixPower = 0.f;
+    float automixGain = 1.f;
+    float automixStep = 0.f;
+
+    // Time alignment and Haas delay, in samples, in a block from the shared arena
+    DaisyDelayLine delayLine;
+    float delayTarget_l = 0.f;
+    float delayTarget_r = 0.f;
+    float delay_l = 0.f;
+    float delay_r = 0.f;
 
     DaisyMessage daisyInputMessage[2][1];
-    DaisyMessage daisyOutputMessage[2][1];
+    DaisyReturnMessage daisyReturnMessage[2][1];
 
     DaisyChannel2() {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
         configParam(CH_LVL_PARAM, 0.0f, 1.0f, 1.0f, "Channel level", " dB", -10, 20);
         configParam(PAN_PARAM, -1.0f, 1.0f, 0.0f, "Panning", "%", 0.f, 100.f);
         configSwitch(MUTE_PARAM, 0.f, 1.f, 0.f, "Mute", {"Not muted", "Muted"});
+        configParam(DUCK_DEPTH_PARAM, 0.f, 1.f, 0.f, "Duck depth", "%", 0.f, 100.f);
+        configParam(DUCK_RELEASE_PARAM, 0.f, 1.f, 0.5f, "Duck release", " ms", 100.f, 10.f);
+        configParam(DELAY_PARAM, 0.f, 500.f, 0.f, "Delay", " ms");
+        configParam(HAAS_PARAM, -30.f, 30.f, 0.f, "Haas delay", " ms");
+        paramQuantities[HAAS_PARAM]->description = "Delays the right side when positive, the left side when negative";
+        configSwitch(CUE_PARAM, 0.f, 1.f, 0.f, "Cue", {"Off", "Pre-fader listen"});
 
         configInput(CH_INPUT_1, "Channel L");
         configInput(CH_INPUT_2, "Channel R");
@@ -49,14 +113,20 @@ struct DaisyChannel2 : Module {
 
         configLight(LINK_LIGHT_L, "Daisy chain link input");
         configLight(LINK_LIGHT_R, "Daisy chain link output");
+        configLight(CUE_LIGHT, "Cued to the master's cue output");
 
         // Set the expander messages
         leftExpander.producerMessage = &daisyInputMessage[0];
         leftExpander.consumerMessage = &daisyInputMessage[1];
-        rightExpander.producerMessage = &daisyOutputMessage[0];
-        rightExpander.consumerMessage = &daisyOutputMessage[1];
+        rightExpander.producerMessage = &daisyReturnMessage[0];
+        rightExpander.consumerMessage = &daisyReturnMessage[1];
 
         lightDivider.setDivision(512);
+        controlDivider.setDivision(32);
+    }
+
+    ~DaisyChannel2() {
+        delayLine.destroy();
     }
 
     json_t *dataToJson() override {
@@ -65,6 +135,20 @@ struct DaisyChannel2 : Module {
         // mute
         json_object_set_new(rootJ, "muted", json_boolean(muted));
 
+        // automation
+        json_object_set_new(rootJ, "automationArmed", json_boolean(automationArmed));
+        json_t *lanesJ = json_array();
+        for (int i = 0; i < NUM_LANES; i++) {
+            json_array_append_new(lanesJ, lanes[i].toJson());
+        }
+        json_object_set_new(rootJ, "lanes", lanesJ);
+
+        // sidechain
+        json_object_set_new(rootJ, "sidechainSource", json_boolean(sidechainSource));
+
+        // automix
+        json_object_set_new(rootJ, "automix", json_boolean(automixEnabled));
+
         return rootJ;
     }
 
@@ -73,10 +157,180 @@ struct DaisyChannel2 : Module {
         json_t *mutedJ = json_object_get(rootJ, "muted");
         if (mutedJ)
             muted = json_is_true(mutedJ);
+
+        // automation
+        json_t *armedJ = json_object_get(rootJ, "automationArmed");
+        if (armedJ)
+            automationArmed = json_is_true(armedJ);
+        json_t *lanesJ = json_object_get(rootJ, "lanes");
+        for (int i = 0; i < NUM_LANES; i++) {
+            lanes[i].fromJson(lanesJ ? json_array_get(lanesJ, i) : NULL);
+        }
+
+        prepareDelay();
+
+        // sidechain
+        json_t *sidechainJ = json_object_get(rootJ, "sidechainSource");
+        if (sidechainJ)
+            sidechainSource = json_is_true(sidechainJ);
+
+        // automix
+        json_t *automixJ = json_object_get(rootJ, "automix");
+        if (automixJ)
+            automixEnabled = json_is_true(automixJ);
+    }
+
+    /** Sets the strip's params from the master's scene morph, called at control rate. */
+    void applyScene(const DaisyReturnMessage &returnMessage) {
+        int a = returnMessage.scene_a;
+        int b = returnMessage.scene_b;
+        float t = returnMessage.scene_morph;
+
+        // Scene b only matters once the morph leaves scene a
+        if (!sceneValid[a] || (t > 0.f && !sceneValid[b])) {
+            return;
+        }
+        DaisyStripState target;
+        if (t <= 0.f) {
+            target = scenes[a];
+        } else if (t >= 1.f) {
+            target = scenes[b];
+        } else {
+            // Fade muted strips through their level instead of switching halfway
+            float level_a = scenes[a].muted ? 0.f : scenes[a].level;
+            float level_b = scenes[b].muted ? 0.f : scenes[b].level;
+            target.level = crossfade(level_a, level_b, t);
+            target.pan = crossfade(scenes[a].pan, scenes[b].pan, t);
+            target.muted = scenes[a].muted && scenes[b].muted;
+        }
+
+        // Only touch the params when the morph moves, so the strip can still be mixed by hand
+        if (sceneWasActive
+            && target.level == sceneApplied.level
+            && target.pan == sceneApplied.pan
+            && target.muted == sceneApplied.muted) {
+            return;
+        }
+        sceneApplied = target;
+        sceneWasActive = true;
+
+        params[CH_LVL_PARAM].setValue(target.level);
+        params[PAN_PARAM].setValue(target.pan);
+        params[MUTE_PARAM].setValue(target.muted ? 1.f : 0.f);
+    }
+
+    /** Records or plays back the strip's lanes, called at control rate. */
+    void updateAutomation(const DaisyReturnMessage &returnMessage) {
+        if (clearAutomation.exchange(false)) {
+            for (int i = 0; i < NUM_LANES; i++) {
+                lanes[i].clear();
+            }
+            automationRecording = false;
+        }
+
+        double position = returnMessage.transport_position;
+        if (returnMessage.automation == DAISY_AUTOMATION_RECORD && automationArmed && returnMessage.transport_running) {
+            lanes[LEVEL_LANE].record(position, params[CH_LVL_PARAM].getValue());
+            lanes[PAN_LANE].record(position, (params[PAN_PARAM].getValue() + 1.f) / 2.f);
+            lanes[MUTE_LANE].record(position, params[MUTE_PARAM].getValue());
+            automationRecording = true;
+            return;
+        }
+        if (automationRecording) {
+            for (int i = 0; i < NUM_LANES; i++) {
+                lanes[i].finishRecording();
+            }
+            automationRecording = false;
+        }
+
+        // Play back, also on strips left unarmed while the others record
+        if (returnMessage.automation == DAISY_AUTOMATION_OFF) {
+            return;
+        }
+        if (!lanes[LEVEL_LANE].empty()) {
+            params[CH_LVL_PARAM].setValue(lanes[LEVEL_LANE].read(position));
+        }
+        if (!lanes[PAN_LANE].empty()) {
+            params[PAN_PARAM].setValue(lanes[PAN_LANE].read(position) * 2.f - 1.f);
+        }
+        if (!lanes[MUTE_LANE].empty()) {
+            params[MUTE_PARAM].setValue(lanes[MUTE_LANE].read(position) >= 0.5f ? 1.f : 0.f);
+        }
+    }
+
+    /** Updates the sidechain envelope and the duck gain ramp, called every 32 samples. */
+    void updateSidechain(const ProcessArgs &args) {
+        float blockTime = args.sampleTime * 32.f;
+        float releaseTime = 0.01f * std::pow(100.f, params[DUCK_RELEASE_PARAM].getValue());
+
+        // The source's envelope decays with a fixed 50ms release, each ducked strip adds its own
+        if (sidechainSource) {
+            sidechainEnvelope = std::max(sidechainPeak, sidechainEnvelope * std::exp(-blockTime / 0.05f));
+        } else {
+            sidechainEnvelope = 0.f;
+        }
+        sidechainPeak = 0.f;
+
+        // Full ducking once the key reaches 5V, Rack's nominal audio level
+        float depth = params[DUCK_DEPTH_PARAM].getValue();
+        float target = 1.f - depth * clamp(sidechainIn / 5.f, 0.f, 1.f);
+        float next = target;
+        if (target > duckGain) {
+            next = target + (duckGain - target) * std::exp(-blockTime / releaseTime);
+        }
+        duckTarget = next;
+        duckStep = (next - duckGain) / 32.f;
+        duckSteps = 32;
+    }
+
+    /**
+     * Smooths this strip's power and ramps towards its share of the automix
+     * total, sqrt(P / sum P), called every 32 samples. The master only relays
+     * the total, so the cost per strip doesn't grow with the chain.
+     */
+    void updateAutomix(const ProcessArgs &args, const DaisyReturnMessage &returnMessage) {
+        float blockTime = args.sampleTime * 32.f;
+        automixPower += (automixSum / 32.f - automixPower) * (1.f - std::exp(-blockTime / 0.02f));
+        automixSum = 0.f;
+
+        automixActive = returnMessage.automix && automixEnabled;
+        float target = 1.f;
+        if (automixActive) {
+            float total = returnMessage.automix_power + returnMessage.automix_strips * DAISY_AUTOMIX_FLOOR;
+            target = std::sqrt(clamp((automixPower + DAISY_AUTOMIX_FLOOR) / total, 0.f, 1.f));
+        }
+        automixStep = (target - automixGain) / 32.f;
+    }
+
+    /** Sets aside the shared delay memory once the strip has a delay, from the UI or patch-loading thread. */
+    void prepareDelay() {
+        if (params[DELAY_PARAM].getValue() != 0.f || params[HAAS_PARAM].getValue() != 0.f) {
+            daisyDelayArena.prepare();
+        }
+    }
+
+    /** Sets the delay targets and sizes the delay line to fit, called at control rate. */
+    void updateDelay(const ProcessArgs &args, int channels) {
+        float samplesPerMs = args.sampleRate / 1000.f;
+        float delay = params[DELAY_PARAM].getValue();
+        float haas = params[HAAS_PARAM].getValue();
+        delayTarget_l = (delay + std::max(-haas, 0.f)) * samplesPerMs;
+        delayTarget_r = (delay + std::max(haas, 0.f)) * samplesPerMs;
+
+        if (delayTarget_l > 0.f || delayTarget_r > 0.f) {
+            float longest = std::max(std::max(delayTarget_l, delayTarget_r), std::max(delay_l, delay_r));
+            delayLine.reserve(longest, channels);
+        } else if (delay_l < 0.5f && delay_r < 0.5f) {
+            // Settled at zero, give the memory back
+            delayLine.release();
+            delay_l = 0.f;
+            delay_r = 0.f;
+        }
     }
 
     void process(const ProcessArgs &args) override {
         muted = params[MUTE_PARAM].getValue() > 0.f;
+        cued = params[CUE_PARAM].getValue() > 0.f;
 
         float signals_l[16] = {};
         float signals_r[16] = {};
@@ -85,6 +339,14 @@ struct DaisyChannel2 : Module {
         int channels = 1;
         int maxChannels = 1;
         int chainChannels = 1;
+        DaisyChainState chainState;
+        DaisyReturnMessage returnMessage;
+
+        // Advance the duck ramp even while muted, landing exactly on the target at the end of the block
+        if (duckSteps > 0) {
+            duckSteps--;
+            duckGain = duckSteps > 0 ? duckGain + duckStep : duckTarget;
+        }
 
         // Get inputs from this channel strip
         if (!muted) {
@@ -101,26 +363,88 @@ struct DaisyChannel2 : Module {
                 inputs[CH_INPUT_1].readVoltages(signals_r);
             }
 
+            float gain_l, gain_r;
+            daisyPan(pan, gain_l, gain_r);
+            gain_l *= gain * gain;
+            gain_r *= gain * gain;
             for (int c = 0; c < channels; c++) {
-                signals_l[c] *= std::pow(gain, 2.f) * std::cos(M_PI * (pan + 1) / 4);
-                signals_r[c] *= std::pow(gain, 2.f) * std::sin(M_PI * (pan + 1) / 4);
+                signals_l[c] *= gain_l;
+                signals_r[c] *= gain_r;
             }
 
             if (inputs[LVL_CV_INPUT].isConnected()) {
+                for (int c = 0; c < channels; c += 4) {
+                    float_4 _cv = simd::clamp(inputs[LVL_CV_INPUT].getPolyVoltageSimd<float_4>(c) / 10.f, 0.f, 1.f);
+                    (float_4::load(&signals_l[c]) * _cv).store(&signals_l[c]);
+                    (float_4::load(&signals_r[c]) * _cv).store(&signals_r[c]);
+                }
+            }
+
+            if (duckGain < 1.f) {
                 for (int c = 0; c < channels; c++) {
-                    float _cv = clamp(inputs[LVL_CV_INPUT].getPolyVoltage(c) / 10.f, 0.f, 1.f);
-                    signals_l[c] *= _cv;
-                    signals_r[c] *= _cv;
+                    signals_l[c] *= duckGain;
+                    signals_r[c] *= duckGain;
+                }
+            }
+
+            if (sidechainSource) {
+                for (int c = 0; c < channels; c++) {
+                    sidechainPeak = std::max(sidechainPeak, std::max(std::fabs(signals_l[c]), std::fabs(signals_r[c])));
+                }
+            }
+
+            // Measure the post-fader level before applying this strip's automix share
+            if (automixActive) {
+                float sum_l = 0.f;
+                float sum_r = 0.f;
+                for (int c = 0; c < channels; c++) {
+                    sum_l += signals_l[c];
+                    sum_r += signals_r[c];
+                }
+                automixSum += 0.5f * (sum_l * sum_l + sum_r * sum_r);
+            }
+
+            if (automixGain < 1.f || automixStep != 0.f) {
+                automixGain += automixStep;
+                for (int c = 0; c < channels; c++) {
+                    signals_l[c] *= automixGain;
+                    signals_r[c] *= automixGain;
                 }
             }
         }
 
-        // Set output for this channel strip
-        outputs[CH_OUTPUT_1].setChannels(channels);
-        outputs[CH_OUTPUT_1].writeVoltages(signals_l);
+        // Delay with glides between settings, voices beyond the block's stride pass through until it grows.
+        // A side that glides down to no delay lands on exactly 0 and skips the line.
+        if (delayLine.buffer) {
+            delay_l += (delayTarget_l - delay_l) * 0.001f;
+            delay_r += (delayTarget_r - delay_r) * 0.001f;
+            if (delayTarget_l == 0.f && delay_l < 0.001f) {
+                delay_l = 0.f;
+            }
+            if (delayTarget_r == 0.f && delay_r < 0.001f) {
+                delay_r = 0.f;
+            }
+            int delayChannels = std::min(channels, delayLine.stride / 2);
+            delayLine.write(signals_l, signals_r, delayChannels);
+            for (int c = 0; c < delayChannels; c++) {
+                if (delay_l > 0.f) {
+                    signals_l[c] = delayLine.read(c, 0, delay_l);
+                }
+                if (delay_r > 0.f) {
+                    signals_r[c] = delayLine.read(c, 1, delay_r);
+                }
+            }
+        }
 
-        outputs[CH_OUTPUT_2].setChannels(channels);
-        outputs[CH_OUTPUT_2].writeVoltages(signals_r);
+        // Set output for this channel strip
+        if (outputs[CH_OUTPUT_1].isConnected()) {
+            outputs[CH_OUTPUT_1].setChannels(channels);
+            outputs[CH_OUTPUT_1].writeVoltages(signals_l);
+        }
+        if (outputs[CH_OUTPUT_2].isConnected()) {
+            outputs[CH_OUTPUT_2].setChannels(channels);
+            outputs[CH_OUTPUT_2].writeVoltages(signals_r);
+        }
 
         // Get daisy-chained data from left-side linked module
         if (leftExpander.module && (
@@ -130,6 +454,10 @@ struct DaisyChannel2 : Module {
             || leftExpander.module->model == modelDaisyChannelSends3
             || leftExpander.module->model == modelDaisyBlank1
             || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
             chainChannels = msgFromModule->channels;
@@ -137,8 +465,13 @@ struct DaisyChannel2 : Module {
                 daisySignals_l[c] = msgFromModule->voltages_l[c];
                 daisySignals_r[c] = msgFromModule->voltages_r[c];
             }
+            chainState = msgFromModule->chain;
+            stripIndex = chainState.strips;
+            sidechainIn = chainState.sidechain;
             link_l = 0.8f;
         } else {
+            stripIndex = 0;
+            sidechainIn = 0.f;
             link_l = 0.0f;
         }
 
@@ -153,20 +486,69 @@ struct DaisyChannel2 : Module {
             || rightExpander.module->model == modelDaisyChannelSends3
             || rightExpander.module->model == modelDaisyBlank1
             || rightExpander.module->model == modelDaisyBlank2
+            || rightExpander.module->model == modelDaisyChannelDynamics
+            || rightExpander.module->model == modelDaisyAnalyzer
+            || rightExpander.module->model == modelDaisyReverb
+            || rightExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
 
-            // Write this module's output to the producer message
-            msgToModule->single_channels = channels;
-            for (int c = 0; c < channels; c++) {
-                msgToModule->single_voltages_l[c] = signals_l[c];
-                msgToModule->single_voltages_r[c] = signals_r[c];
+            // Get the return message coming back from the master
+            returnMessage = *(DaisyReturnMessage *)(rightExpander.consumerMessage);
+
+            // Report this strip's settings when the master asks for them
+            if (returnMessage.report_strip == stripIndex) {
+                chainState.report_strip = stripIndex;
+                chainState.report.level = params[CH_LVL_PARAM].getValue();
+                chainState.report.pan = params[PAN_PARAM].getValue();
+                chainState.report.muted = muted;
+            }
+            chainState.strips = stripIndex + 1;
+            chainState.sidechain = std::max(chainState.sidechain, sidechainEnvelope);
+            if (automixEnabled) {
+                chainState.automix_power += automixPower;
+                chainState.automix_strips++;
+            }
+
+            // Put this strip's inputs on the cue bus, before the fader, pan and mute
+            const DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
+            if (cued) {
+                float cue_l[16] = {};
+                float cue_r[16] = {};
+                int cueChannels = std::max(std::max(inputs[CH_INPUT_1].getChannels(), inputs[CH_INPUT_2].getChannels()), 1);
+                inputs[CH_INPUT_1].readVoltages(cue_l);
+                if (inputs[CH_INPUT_2].isConnected()) {
+                    inputs[CH_INPUT_2].readVoltages(cue_r);
+                } else {
+                    inputs[CH_INPUT_1].readVoltages(cue_r);
+                }
+                for (int c = 0; c < chainState.cue_channels; c++) {
+                    cue_l[c] += msgFromModule->cue_l[c];
+                    cue_r[c] += msgFromModule->cue_r[c];
+                }
+                chainState.cue_channels = std::max(chainState.cue_channels, cueChannels);
+                for (int c = 0; c < chainState.cue_channels; c++) {
+                    msgToModule->cue_l[c] = cue_l[c];
+                    msgToModule->cue_r[c] = cue_r[c];
+                }
+            } else {
+                daisyRelayCue(chainState, msgFromModule, msgToModule);
+            }
+            msgToModule->chain = chainState;
+
+            // Write this module's output to the producer message, if the right-side module reads it
+            if (returnMessage.needs_single) {
+                msgToModule->single_channels = channels;
+                for (int c = 0; c < channels; c++) {
+                    msgToModule->single_voltages_l[c] = signals_l[c];
+                    msgToModule->single_voltages_r[c] = signals_r[c];
+                }
             }
 
             // Combine this module's signal with daisy-chain
             for (int c = 0; c < maxChannels; c++) {
-                daisySignals_l[c] += signals_l[c] / DAISY_DIVISOR;
-                daisySignals_r[c] += signals_r[c] / DAISY_DIVISOR;
+                daisySignals_l[c] += signals_l[c];
+                daisySignals_r[c] += signals_r[c];
             }
 
             // Write daisy-chain signal to producer message
@@ -183,9 +565,38 @@ struct DaisyChannel2 : Module {
             link_r = 0.0f;
         }
 
+        // Keep this strip's part of the scene table in sync with the master
+        if (returnMessage.sync_strip == stripIndex) {
+            scenes[returnMessage.sync_scene] = returnMessage.sync;
+            sceneValid[returnMessage.sync_scene] = returnMessage.sync_valid;
+        }
+
+        if (controlDivider.process()) {
+            updateSidechain(args);
+            updateAutomix(args, returnMessage);
+            updateDelay(args, channels);
+            if (returnMessage.scene_active) {
+                applyScene(returnMessage);
+            } else {
+                sceneWasActive = false;
+            }
+            updateAutomation(returnMessage);
+        }
+
+        // Pass the return message on to the left-side linked module, with this module's demand for single voltages
+        if (link_l > 0.f) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            returnToModule->needs_single = false;
+            returnToModule->needs_aux = false;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
+
         // Set lights
         if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
             lights[MUTE_LIGHT].value = (muted);
+            lights[CUE_LIGHT].setBrightness(cued);
             lights[LINK_LIGHT_L].setBrightness(link_l);
             lights[LINK_LIGHT_R].setBrightness(link_r);
         }
@@ -218,6 +629,73 @@ struct DaisyChannelWidget2 : ModuleWidget {
         // Link lights
         addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH - 4, 361.0f), module, DaisyChannel2::LINK_LIGHT_L));
         addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH + 4, 361.0f), module, DaisyChannel2::LINK_LIGHT_R));
+
+        // Cue, switched from the menu as the strip has no room left for a button
+        addChild(createLightCentered<TinyLight<GreenLight>>(Vec(RACK_GRID_WIDTH, 351.0f), module, DaisyChannel2::CUE_LIGHT));
+    }
+
+    void step() override {
+        DaisyChannel2 *module = dynamic_cast<DaisyChannel2 *>(this->module);
+        if (module) {
+            module->prepareDelay();
+        }
+        ModuleWidget::step();
+    }
+
+    void appendContextMenu(Menu *menu) override {
+        DaisyChannel2 *module = dynamic_cast<DaisyChannel2 *>(this->module);
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createBoolMenuItem("Cue (pre-fader listen)", "",
+            [=]() { return module->params[DaisyChannel2::CUE_PARAM].getValue() > 0.f; },
+            [=](bool cue) { module->params[DaisyChannel2::CUE_PARAM].setValue(cue ? 1.f : 0.f); }
+        ));
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createMenuLabel("Delay"));
+
+        ui::Slider *delaySlider = new ui::Slider;
+        delaySlider->quantity = module->paramQuantities[DaisyChannel2::DELAY_PARAM];
+        delaySlider->box.size.x = 200.f;
+        menu->addChild(delaySlider);
+
+        ui::Slider *haasSlider = new ui::Slider;
+        haasSlider->quantity = module->paramQuantities[DaisyChannel2::HAAS_PARAM];
+        haasSlider->box.size.x = 200.f;
+        menu->addChild(haasSlider);
+
+        // The shared delay memory ran out, the strip keeps the longest delay it already has
+        if (module->delayLine.starved) {
+            float maxMs = module->delayLine.getMaxDelay() * 1000.f / APP->engine->getSampleRate();
+            menu->addChild(createMenuLabel(string::f("Delay memory full, limited to %.0f ms", maxMs)));
+        }
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createMenuLabel("Sidechain"));
+        menu->addChild(createBoolPtrMenuItem("Sidechain source", "", &module->sidechainSource));
+
+        ui::Slider *depthSlider = new ui::Slider;
+        depthSlider->quantity = module->paramQuantities[DaisyChannel2::DUCK_DEPTH_PARAM];
+        depthSlider->box.size.x = 200.f;
+        menu->addChild(depthSlider);
+
+        ui::Slider *releaseSlider = new ui::Slider;
+        releaseSlider->quantity = module->paramQuantities[DaisyChannel2::DUCK_RELEASE_PARAM];
+        releaseSlider->box.size.x = 200.f;
+        menu->addChild(releaseSlider);
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createBoolPtrMenuItem("Join the master's automix", "", &module->automixEnabled));
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createMenuLabel("Automation"));
+        menu->addChild(createBoolPtrMenuItem("Arm for recording", "", &module->automationArmed));
+        menu->addChild(createMenuItem("Clear automation", "",
+            [=]() { module->clearAutomation = true; }
+        ));
+        if (module->lanes[DaisyChannel2::LEVEL_LANE].full || module->lanes[DaisyChannel2::PAN_LANE].full || module->lanes[DaisyChannel2::MUTE_LANE].full) {
+            menu->addChild(createMenuLabel("Automation full, later moves were dropped"));
+        }
     }
 };
 
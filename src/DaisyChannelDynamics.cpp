@@ -0,0 +1,331 @@
+#include "QuantalAudioExtendedMixer.hpp"
+#include "Daisy.hpp"
+#include "DaisyMath.hpp"
+#include "DaisyGovernor.hpp"
+
+static const int GR_LIGHT_COUNT = 8;
+
+// Gain reduction (dB) at which each meter segment lights up
+static const float GR_LIGHT_DB[GR_LIGHT_COUNT] = {1.f, 2.f, 3.f, 4.5f, 6.f, 9.f, 12.f, 18.f};
+
+// Gate threshold at its minimum turns the gate off
+static const float GATE_OFF_DB = -80.f;
+
+// Gate closes this far below its threshold
+static const float GATE_HYSTERESIS_DB = 4.f;
+
+struct DaisyChannelDynamics : Module {
+    enum ParamIds {
+        GATE_THRESH_PARAM,
+        COMP_THRESH_PARAM,
+        RATIO_PARAM,
+        ATTACK_PARAM,
+        RELEASE_PARAM,
+        MAKEUP_PARAM,
+        NUM_PARAMS
+    };
+    enum InputIds {
+        NUM_INPUTS
+    };
+    enum OutputIds {
+        NUM_OUTPUTS
+    };
+    enum LightsIds {
+        LINK_LIGHT_L,
+        LINK_LIGHT_R,
+        GATE_LIGHT,
+        ENUMS(GR_LIGHTS, GR_LIGHT_COUNT),
+        NUM_LIGHTS
+    };
+
+    float link_l = 0.f;
+    float link_r = 0.f;
+    bool bypassed = true;
+
+    // Per-voice envelope state, four voices per lane
+    float_4 env[4] = {};
+    float_4 gateGain[4] = {};
+    float_4 gateOpen[4] = {};
+
+    // Control-rate coefficients
+    float attackCoef = 1.f;
+    float releaseCoef = 1.f;
+    float gateAttackCoef = 1.f;
+    float compThreshDb = 0.f;
+    float compSlope = 0.f;
+    float gateThreshDb = GATE_OFF_DB;
+    float makeupDb = 0.f;
+
+    // Largest gain reduction since the last light update
+    float grPeakDb = 0.f;
+    bool gateIsOpen = true;
+
+    dsp::ClockDivider paramDivider;
+    dsp::ClockDivider lightDivider;
+
+    DaisyMessage daisyInputMessage[2][1];
+    DaisyReturnMessage daisyReturnMessage[2][1];
+
+    DaisyChannelDynamics() {
+        config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+        configParam(GATE_THRESH_PARAM, GATE_OFF_DB, 0.f, GATE_OFF_DB, "Gate threshold", " dB");
+        configParam(COMP_THRESH_PARAM, -40.f, 0.f, -12.f, "Compressor threshold", " dB");
+        configParam(RATIO_PARAM, 1.f, 20.f, 1.f, "Compressor ratio", ":1");
+        configParam(ATTACK_PARAM, 0.f, 1.f, 0.5f, "Attack", " ms", 1000.f, 0.1f);
+        configParam(RELEASE_PARAM, 0.f, 1.f, 0.5f, "Release", " ms", 100.f, 10.f);
+        configParam(MAKEUP_PARAM, 0.f, 24.f, 0.f, "Makeup gain", " dB");
+
+        configLight(LINK_LIGHT_L, "Daisy chain link input");
+        configLight(LINK_LIGHT_R, "Daisy chain link output");
+        configLight(GATE_LIGHT, "Gate open");
+
+        // Set the expander messages
+        leftExpander.producerMessage = &daisyInputMessage[0];
+        leftExpander.consumerMessage = &daisyInputMessage[1];
+        rightExpander.producerMessage = &daisyReturnMessage[0];
+        rightExpander.consumerMessage = &daisyReturnMessage[1];
+
+        paramDivider.setDivision(32);
+        lightDivider.setDivision(512);
+    }
+
+    /** Refreshes the detector coefficients, called at control rate. */
+    void updateCoefficients(float sampleRate) {
+        float attackMs = 0.1f * std::pow(1000.f, params[ATTACK_PARAM].getValue());
+        float releaseMs = 10.f * std::pow(100.f, params[RELEASE_PARAM].getValue());
+        attackCoef = 1.f - std::exp(-1000.f / (attackMs * sampleRate));
+        releaseCoef = 1.f - std::exp(-1000.f / (releaseMs * sampleRate));
+        gateAttackCoef = 1.f - std::exp(-1000.f / (0.5f * sampleRate));
+
+        float ratio = params[RATIO_PARAM].getValue();
+        compThreshDb = params[COMP_THRESH_PARAM].getValue();
+        compSlope = 1.f - 1.f / ratio;
+        gateThreshDb = params[GATE_THRESH_PARAM].getValue();
+        makeupDb = params[MAKEUP_PARAM].getValue();
+
+        // Nothing to do while every stage is at its neutral setting
+        bool neutral = ratio <= 1.f && gateThreshDb <= GATE_OFF_DB && makeupDb <= 0.f;
+        if (neutral && !bypassed) {
+            for (int i = 0; i < 4; i++) {
+                env[i] = 0.f;
+                gateGain[i] = 1.f;
+                gateOpen[i] = 1.f;
+            }
+        }
+        bypassed = neutral;
+    }
+
+    /** Applies gate and compressor to the strip signal in place. */
+    void processDynamics(int channels, float *signals_l, float *signals_r) {
+        bool gateOn = gateThreshDb > GATE_OFF_DB;
+        float_4 grMax = 0.f;
+        float_4 openAny = 0.f;
+
+        for (int c = 0; c < channels; c += 4) {
+            int i = c / 4;
+            float_4 in_l = float_4::load(&signals_l[c]);
+            float_4 in_r = float_4::load(&signals_r[c]);
+
+            // Stereo-linked peak detector, 10V = 0 dB
+            float_4 level = simd::fmax(simd::abs(in_l), simd::abs(in_r)) / 10.f;
+            float_4 coef = simd::ifelse(level > env[i], float_4(attackCoef), float_4(releaseCoef));
+            env[i] += coef * (level - env[i]);
+
+            float_4 envDb = daisyAmplitudeToDb(simd::fmax(env[i], float_4(1e-6f)));
+
+            // Feed-forward compressor with a hard knee
+            float_4 grDb = simd::fmax(envDb - compThreshDb, float_4(0.f)) * compSlope;
+            grMax = simd::fmax(grMax, grDb);
+
+            float_4 gain = daisyDbToAmplitude(makeupDb - grDb);
+
+            if (gateOn) {
+                gateOpen[i] = simd::ifelse(envDb > gateThreshDb, float_4(1.f),
+                                           simd::ifelse(envDb < gateThreshDb - GATE_HYSTERESIS_DB, float_4(0.f), gateOpen[i]));
+                float_4 gateCoef = simd::ifelse(gateOpen[i] > gateGain[i], float_4(gateAttackCoef), float_4(releaseCoef));
+                gateGain[i] += gateCoef * (gateOpen[i] - gateGain[i]);
+                gain *= gateGain[i];
+                openAny = simd::fmax(openAny, gateOpen[i]);
+            }
+
+            (in_l * gain).store(&signals_l[c]);
+            (in_r * gain).store(&signals_r[c]);
+        }
+
+        grPeakDb = std::max(grPeakDb, std::max(std::max(grMax[0], grMax[1]), std::max(grMax[2], grMax[3])));
+        if (gateOn) {
+            gateIsOpen = gateIsOpen || openAny[0] > 0.f || openAny[1] > 0.f || openAny[2] > 0.f || openAny[3] > 0.f;
+        }
+    }
+
+    void process(const ProcessArgs &args) override {
+        float signals_l[16] = {};
+        float signals_r[16] = {};
+        float daisySignals_l[16] = {};
+        float daisySignals_r[16] = {};
+        int channels = 0;
+        int chainChannels = 1;
+        DaisyChainState chainState;
+        DaisyReturnMessage returnMessage;
+
+        if (paramDivider.process()) {
+            updateCoefficients(args.sampleRate);
+        }
+
+        // Get daisy-chained data from left-side linked module
+        if (leftExpander.module && (
+            leftExpander.module->model == modelDaisyChannel2
+            || leftExpander.module->model == modelDaisyChannelVu
+            || leftExpander.module->model == modelDaisyChannelSends2
+            || leftExpander.module->model == modelDaisyChannelSends3
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyBlank1
+            || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
+        )) {
+            DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
+            chainChannels = msgFromModule->channels;
+            chainState = msgFromModule->chain;
+            for (int c = 0; c < chainChannels; c++) {
+                daisySignals_l[c] = msgFromModule->voltages_l[c];
+                daisySignals_r[c] = msgFromModule->voltages_r[c];
+            }
+
+            // Only strips put their own signal in the single voltages
+            if (leftExpander.module->model == modelDaisyChannel2
+                || leftExpander.module->model == modelDaisyChannelSends3
+                || leftExpander.module->model == modelDaisyChannelDynamics
+            ) {
+                channels = msgFromModule->single_channels;
+                for (int c = 0; c < channels; c++) {
+                    signals_l[c] = msgFromModule->single_voltages_l[c];
+                    signals_r[c] = msgFromModule->single_voltages_r[c];
+                }
+            }
+
+            link_l = 0.8f;
+        } else {
+            link_l = 0.0f;
+        }
+
+        if (!bypassed && channels > 0) {
+            float dry_l[16];
+            float dry_r[16];
+            std::memcpy(dry_l, signals_l, sizeof(dry_l));
+            std::memcpy(dry_r, signals_r, sizeof(dry_r));
+
+            processDynamics(channels, signals_l, signals_r);
+
+            // Swap the strip's dry contribution in the chain for the processed one, widening
+            // the chain if the strip carries more voices than arrived on it
+            chainChannels = std::max(chainChannels, channels);
+            for (int c = 0; c < chainChannels; c++) {
+                daisySignals_l[c] += signals_l[c] - dry_l[c];
+                daisySignals_r[c] += signals_r[c] - dry_r[c];
+            }
+        }
+
+        // Set daisy-chained output to right-side linked module
+        if (rightExpander.module && (
+            rightExpander.module->model == modelDaisyMaster2
+            || rightExpander.module->model == modelDaisyChannel2
+            || rightExpander.module->model == modelDaisyChannelVu
+            || rightExpander.module->model == modelDaisyChannelSends2
+            || rightExpander.module->model == modelDaisyChannelSends3
+            || rightExpander.module->model == modelDaisyChannelDynamics
+            || rightExpander.module->model == modelDaisyBlank1
+            || rightExpander.module->model == modelDaisyBlank2
+            || rightExpander.module->model == modelDaisyAnalyzer
+            || rightExpander.module->model == modelDaisyReverb
+            || rightExpander.module->model == modelDaisyMatrix
+        )) {
+            DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
+
+            msgToModule->channels = chainChannels;
+            msgToModule->chain = chainState;
+            daisyRelayCue(chainState, (DaisyMessage *)(leftExpander.consumerMessage), msgToModule);
+
+            // Get the return message coming back from the master
+            returnMessage = *(DaisyReturnMessage *)(rightExpander.consumerMessage);
+
+            // Pass the processed strip signal on, e.g. to a VU meter
+            if (returnMessage.needs_single) {
+                msgToModule->single_channels = channels;
+                for (int c = 0; c < channels; c++) {
+                    msgToModule->single_voltages_l[c] = signals_l[c];
+                    msgToModule->single_voltages_r[c] = signals_r[c];
+                }
+            }
+
+            for (int c = 0; c < chainChannels; c++) {
+                msgToModule->voltages_l[c] = daisySignals_l[c];
+                msgToModule->voltages_r[c] = daisySignals_r[c];
+            }
+
+            rightExpander.module->leftExpander.messageFlipRequested = true;
+
+            link_r = 0.8f;
+        } else {
+            link_r = 0.0f;
+        }
+
+        // Pass the return message on to the left-side linked module, with this module's demand for single voltages
+        if (link_l > 0.f) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            returnToModule->needs_single = !bypassed || returnMessage.needs_single;
+            returnToModule->needs_aux = bypassed && returnMessage.needs_aux;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
+
+        // Set lights
+        if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
+            for (int i = 0; i < GR_LIGHT_COUNT; i++) {
+                lights[GR_LIGHTS + i].setBrightness(grPeakDb >= GR_LIGHT_DB[i] ? 1.f : 0.f);
+            }
+            lights[GATE_LIGHT].setBrightness(!bypassed && gateThreshDb > GATE_OFF_DB && gateIsOpen ? 1.f : 0.f);
+            lights[LINK_LIGHT_L].setBrightness(link_l);
+            lights[LINK_LIGHT_R].setBrightness(link_r);
+            grPeakDb = 0.f;
+            gateIsOpen = false;
+        }
+    }
+};
+
+struct DaisyChannelDynamicsWidget : ModuleWidget {
+    DaisyChannelDynamicsWidget(DaisyChannelDynamics *module) {
+        setModule(module);
+        setPanel(createPanel(asset::plugin(pluginInstance, "res/DaisyChannelDynamics.svg"), asset::plugin(pluginInstance, "res/DaisyChannelDynamics-dark.svg")));
+
+        // Screws
+        addChild(createWidget<ThemedScrew>(Vec(RACK_GRID_WIDTH, 0)));
+        addChild(createWidget<ThemedScrew>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, 0)));
+        addChild(createWidget<ThemedScrew>(Vec(RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+        addChild(createWidget<ThemedScrew>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+
+        // Gate
+        addParam(createParamCentered<Trimpot>(Vec(RACK_GRID_WIDTH * 1.5, 60.0), module, DaisyChannelDynamics::GATE_THRESH_PARAM));
+        addChild(createLightCentered<SmallLight<GreenLight>>(Vec(RACK_GRID_WIDTH * 1.5 + 14, 45.2), module, DaisyChannelDynamics::GATE_LIGHT));
+
+        // Compressor
+        addParam(createParamCentered<Trimpot>(Vec(RACK_GRID_WIDTH * 1.5, 95.0), module, DaisyChannelDynamics::COMP_THRESH_PARAM));
+        addParam(createParamCentered<Trimpot>(Vec(RACK_GRID_WIDTH * 1.5, 125.0), module, DaisyChannelDynamics::RATIO_PARAM));
+        addParam(createParamCentered<Trimpot>(Vec(RACK_GRID_WIDTH * 1.5, 155.0), module, DaisyChannelDynamics::ATTACK_PARAM));
+        addParam(createParamCentered<Trimpot>(Vec(RACK_GRID_WIDTH * 1.5, 185.0), module, DaisyChannelDynamics::RELEASE_PARAM));
+        addParam(createParamCentered<Trimpot>(Vec(RACK_GRID_WIDTH * 1.5, 215.0), module, DaisyChannelDynamics::MAKEUP_PARAM));
+
+        // Gain reduction meter, hanging down from 1 dB
+        for (int i = 0; i < GR_LIGHT_COUNT; i++) {
+            addChild(createLightCentered<SmallLight<YellowLight>>(Vec(RACK_GRID_WIDTH * 1.5, 250.f + i * 10), module, DaisyChannelDynamics::GR_LIGHTS + i));
+        }
+
+        // Link lights
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH * 1.5 - 4, 361.0f), module, DaisyChannelDynamics::LINK_LIGHT_L));
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH * 1.5 + 4, 361.0f), module, DaisyChannelDynamics::LINK_LIGHT_R));
+    }
+};
+
+Model *modelDaisyChannelDynamics = createModel<DaisyChannelDynamics, DaisyChannelDynamicsWidget>("DaisyChannelDynamics");
@@ -1,5 +1,6 @@
 #include "QuantalAudioExtendedMixer.hpp"
 #include "Daisy.hpp"
+#include "DaisyGovernor.hpp"
 
 struct DaisyChannelSends2 : Module {
     enum ParamIds {
@@ -20,12 +21,13 @@ struct DaisyChannelSends2 : Module {
     };
 
     bool muted = false;
+    int headroom = DAISY_HEADROOM_CLIP;
     float link_l = 0.f;
     float link_r = 0.f;
     dsp::ClockDivider lightDivider;
 
     DaisyMessage daisyInputMessage[2][1];
-    DaisyMessage daisyOutputMessage[2][1];
+    DaisyReturnMessage daisyReturnMessage[2][1];
 
     DaisyChannelSends2() {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -39,16 +41,34 @@ struct DaisyChannelSends2 : Module {
         // Set the expander messages
         leftExpander.producerMessage = &daisyInputMessage[0];
         leftExpander.consumerMessage = &daisyInputMessage[1];
-        rightExpander.producerMessage = &daisyOutputMessage[0];
-        rightExpander.consumerMessage = &daisyOutputMessage[1];
+        rightExpander.producerMessage = &daisyReturnMessage[0];
+        rightExpander.consumerMessage = &daisyReturnMessage[1];
 
         lightDivider.setDivision(512);
     }
 
+    json_t *dataToJson() override {
+        json_t *rootJ = json_object();
+
+        // headroom
+        json_object_set_new(rootJ, "headroom", json_integer(headroom));
+
+        return rootJ;
+    }
+
+    void dataFromJson(json_t *rootJ) override {
+        // headroom, patches from before the unscaled bus clip at 12V
+        json_t *headroomJ = json_object_get(rootJ, "headroom");
+        if (headroomJ)
+            headroom = clamp((int)json_integer_value(headroomJ), 0, DAISY_HEADROOM_COUNT - 1);
+    }
+
     void process(const ProcessArgs &args) override {
         float mix_l[16] = {};
         float mix_r[16] = {};
         int chainChannels = 1;
+        DaisyChainState chainState;
+        DaisyReturnMessage returnMessage;
 
         // Get daisy-chained data from left-side linked module
         if (leftExpander.module && (
@@ -58,10 +78,15 @@ struct DaisyChannelSends2 : Module {
             || leftExpander.module->model == modelDaisyChannelSends3
             || leftExpander.module->model == modelDaisyBlank1
             || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
 
             chainChannels = msgFromModule->channels;
+            chainState = msgFromModule->chain;
             for (int c = 0; c < chainChannels; c++) {
                 mix_l[c] = msgFromModule->voltages_l[c];
                 mix_r[c] = msgFromModule->voltages_r[c];
@@ -80,9 +105,19 @@ struct DaisyChannelSends2 : Module {
             || rightExpander.module->model == modelDaisyChannelSends3
             || rightExpander.module->model == modelDaisyBlank1
             || rightExpander.module->model == modelDaisyBlank2
+            || rightExpander.module->model == modelDaisyChannelDynamics
+            || rightExpander.module->model == modelDaisyAnalyzer
+            || rightExpander.module->model == modelDaisyReverb
+            || rightExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
             msgToModule->channels = chainChannels;
+            msgToModule->chain = chainState;
+            daisyRelayCue(chainState, (DaisyMessage *)(leftExpander.consumerMessage), msgToModule);
+
+            // Get the return message coming back from the master
+            returnMessage = *(DaisyReturnMessage *)(rightExpander.consumerMessage);
+
             for (int c = 0; c < chainChannels; c++) {
                 msgToModule->voltages_l[c] = mix_l[c];
                 msgToModule->voltages_r[c] = mix_r[c];
@@ -93,14 +128,20 @@ struct DaisyChannelSends2 : Module {
             link_r = 0.0f;
         }
 
-        // Bring the voltage back up from the chained low voltage
-        for (int c = 0; c < chainChannels; c++) {
-            mix_l[c] = clamp(mix_l[c] * DAISY_DIVISOR, -12.f, 12.f) * 1;
-            mix_r[c] = clamp(mix_r[c] * DAISY_DIVISOR, -12.f, 12.f) * 1;
+        // Only decode the aux bus if it is patched or read by the right-side module
+        bool outputsConnected = outputs[CH_OUTPUT_1].isConnected() || outputs[CH_OUTPUT_2].isConnected();
+        bool singleNeeded = link_r > 0.f && returnMessage.needs_single;
+
+        // Apply the headroom policy to the aux bus leaving the chain
+        if (headroom != DAISY_HEADROOM_NONE && (outputsConnected || singleNeeded)) {
+            for (int c = 0; c < chainChannels; c++) {
+                mix_l[c] = daisyHeadroom(mix_l[c], headroom);
+                mix_r[c] = daisyHeadroom(mix_r[c], headroom);
+            }
         }
 
-        // Set daisy-chained output to right-side linked module
-        if (rightExpander.module && rightExpander.module->model == modelDaisyChannelVu) {
+        // Set daisy-chained output to right-side linked module, if a module on the right reads it
+        if (singleNeeded) {
             // Write this module's output to the producer message
             DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
             msgToModule->single_channels = chainChannels;
@@ -115,13 +156,25 @@ struct DaisyChannelSends2 : Module {
         }
 
         // Set aggregated decoded output
-        outputs[CH_OUTPUT_1].setChannels(chainChannels);
-        outputs[CH_OUTPUT_1].writeVoltages(mix_l);
-        outputs[CH_OUTPUT_2].setChannels(chainChannels);
-        outputs[CH_OUTPUT_2].writeVoltages(mix_r);
+        if (outputsConnected) {
+            outputs[CH_OUTPUT_1].setChannels(chainChannels);
+            outputs[CH_OUTPUT_1].writeVoltages(mix_l);
+            outputs[CH_OUTPUT_2].setChannels(chainChannels);
+            outputs[CH_OUTPUT_2].writeVoltages(mix_r);
+        }
+
+        // Pass the return message on to the left-side linked module, with this module's demand for single voltages
+        if (link_l > 0.f) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            returnToModule->needs_single = false;
+            returnToModule->needs_aux = false;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
 
         // Set lights
         if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
             lights[LINK_LIGHT_L].setBrightness(link_l);
             lights[LINK_LIGHT_R].setBrightness(link_r);
         }
@@ -146,6 +199,13 @@ struct DaisyChannelSendsWidget2 : ModuleWidget {
         addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH - 4, 361.0f), module, DaisyChannelSends2::LINK_LIGHT_L));
         addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH + 4, 361.0f), module, DaisyChannelSends2::LINK_LIGHT_R));
     }
+
+    void appendContextMenu(Menu *menu) override {
+        DaisyChannelSends2 *module = dynamic_cast<DaisyChannelSends2 *>(this->module);
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createIndexPtrSubmenuItem("Headroom", {"Clip at 12V", "Soft clip", "Unlimited"}, &module->headroom));
+    }
 };
 
 Model *modelDaisyChannelSends2 = createModel<DaisyChannelSends2, DaisyChannelSendsWidget2>("DaisyChannelSends2");
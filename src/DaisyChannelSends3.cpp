@@ -1,11 +1,14 @@
 #include "QuantalAudioExtendedMixer.hpp"
 #include "Daisy.hpp"
+#include "DaisyMath.hpp"
+#include "DaisyGovernor.hpp"
 
 struct DaisyChannelSends3 : Module {
     enum ParamIds {
         CH_LVL_PARAM,
         MUTE_PARAM,
         PAN_PARAM,
+        CUE_PARAM,
         NUM_PARAMS
     };
     enum InputIds {
@@ -21,16 +24,19 @@ struct DaisyChannelSends3 : Module {
         MUTE_LIGHT,
         LINK_LIGHT_L,
         LINK_LIGHT_R,
+        CUE_LIGHT,
         NUM_LIGHTS
     };
 
     bool muted = false;
+    bool cued = false;
+    int headroom = DAISY_HEADROOM_CLIP;
     float link_l = 0.f;
     float link_r = 0.f;
     dsp::ClockDivider lightDivider;
 
     DaisyMessage daisyInputMessage[2][1];
-    DaisyMessage daisyOutputMessage[2][1];
+    DaisyReturnMessage daisyReturnMessage[2][1];
 
     DaisyChannelSends3() {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -38,6 +44,7 @@ struct DaisyChannelSends3 : Module {
         configParam(CH_LVL_PARAM, 0.0f, 1.0f, 1.0f, "Dry Level", " dB", -10, 20);
         configParam(PAN_PARAM, -1.0f, 1.0f, 0.0f, "Dry Panning", "%", 0.f, 100.f);
         configSwitch(MUTE_PARAM, 0.f, 1.f, 0.f, "Dry Mute", { "Not muted", "Muted" });
+        configSwitch(CUE_PARAM, 0.f, 1.f, 0.f, "Cue", { "Off", "Pre-fader listen" });
 
         configInput(LVL_CV_INPUT, "Dry Level CV");
 
@@ -50,8 +57,8 @@ struct DaisyChannelSends3 : Module {
         // Set the expander messages
         leftExpander.producerMessage = &daisyInputMessage[0];
         leftExpander.consumerMessage = &daisyInputMessage[1];
-        rightExpander.producerMessage = &daisyOutputMessage[0];
-        rightExpander.consumerMessage = &daisyOutputMessage[1];
+        rightExpander.producerMessage = &daisyReturnMessage[0];
+        rightExpander.consumerMessage = &daisyReturnMessage[1];
 
         lightDivider.setDivision(512);
     }
@@ -62,6 +69,9 @@ struct DaisyChannelSends3 : Module {
         // mute
         json_object_set_new(rootJ, "muted", json_boolean(muted));
 
+        // headroom
+        json_object_set_new(rootJ, "headroom", json_integer(headroom));
+
         return rootJ;
     }
 
@@ -70,6 +80,11 @@ struct DaisyChannelSends3 : Module {
         json_t* mutedJ = json_object_get(rootJ, "muted");
         if (mutedJ)
             muted = json_is_true(mutedJ);
+
+        // headroom, patches from before the unscaled bus clip at 12V
+        json_t* headroomJ = json_object_get(rootJ, "headroom");
+        if (headroomJ)
+            headroom = clamp((int)json_integer_value(headroomJ), 0, DAISY_HEADROOM_COUNT - 1);
     }
 
     void process(const ProcessArgs &args) override {
@@ -80,7 +95,10 @@ struct DaisyChannelSends3 : Module {
         float gain = params[CH_LVL_PARAM].getValue();
         float pan = params[PAN_PARAM].getValue();
         muted = params[MUTE_PARAM].getValue() > 0.f;
+        cued = params[CUE_PARAM].getValue() > 0.f;
         int chainChannels = 1;
+        DaisyChainState chainState;
+        DaisyReturnMessage returnMessage;
 
         // Get daisy-chained data from left-side linked module
         if (leftExpander.module && (
@@ -90,32 +108,38 @@ struct DaisyChannelSends3 : Module {
             || leftExpander.module->model == modelDaisyChannelSends2
             || leftExpander.module->model == modelDaisyBlank1
             || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
 
             chainChannels = msgFromModule->channels;
+            chainState = msgFromModule->chain;
+            float gain_l, gain_r;
+            daisyPan(pan, gain_l, gain_r);
+            gain_l *= gain * gain;
+            gain_r *= gain * gain;
             for (int c = 0; c < chainChannels; c++) {
                 mix_l[c] = msgFromModule->voltages_l[c];
                 mix_r[c] = msgFromModule->voltages_r[c];
                 if (!muted) {
                     signals_l[c] = msgFromModule->voltages_l[c];
                     signals_r[c] = msgFromModule->voltages_r[c];
-                    signals_l[c] *= std::pow(gain, 2.f) * std::cos(M_PI * (pan + 1) / 4);
-                    signals_r[c] *= std::pow(gain, 2.f) * std::sin(M_PI * (pan + 1) / 4);
+                    signals_l[c] *= gain_l;
+                    signals_r[c] *= gain_r;
                 }
             }
             link_l = 0.8f;
         } else {
             link_l = 0.0f;
         }
-        if (inputs[LVL_CV_INPUT].isConnected()) {
-            for (int c = 0; c < chainChannels; c++) {
-                if (!muted) 
-                {
-                    float _cv = clamp(inputs[LVL_CV_INPUT].getPolyVoltage(c) / 10.f, 0.f, 1.f);
-                    signals_l[c] *= _cv;
-                    signals_r[c] *= _cv;
-                }
+        if (inputs[LVL_CV_INPUT].isConnected() && !muted) {
+            for (int c = 0; c < chainChannels; c += 4) {
+                float_4 _cv = simd::clamp(inputs[LVL_CV_INPUT].getPolyVoltageSimd<float_4>(c) / 10.f, 0.f, 1.f);
+                (float_4::load(&signals_l[c]) * _cv).store(&signals_l[c]);
+                (float_4::load(&signals_r[c]) * _cv).store(&signals_r[c]);
             }
         }
         // Set daisy-chained output to right-side linked module
@@ -127,9 +151,35 @@ struct DaisyChannelSends3 : Module {
             || rightExpander.module->model == modelDaisyChannelSends3
             || rightExpander.module->model == modelDaisyBlank1
             || rightExpander.module->model == modelDaisyBlank2
+            || rightExpander.module->model == modelDaisyChannelDynamics
+            || rightExpander.module->model == modelDaisyAnalyzer
+            || rightExpander.module->model == modelDaisyReverb
+            || rightExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
             msgToModule->channels = chainChannels;
+
+            // Put the aux bus on the cue bus, before the dry fader, pan and mute
+            const DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
+            if (cued) {
+                int cueChannels = std::max(chainState.cue_channels, chainChannels);
+                for (int c = 0; c < cueChannels; c++) {
+                    msgToModule->cue_l[c] = mix_l[c];
+                    msgToModule->cue_r[c] = mix_r[c];
+                }
+                for (int c = 0; c < chainState.cue_channels; c++) {
+                    msgToModule->cue_l[c] += msgFromModule->cue_l[c];
+                    msgToModule->cue_r[c] += msgFromModule->cue_r[c];
+                }
+                chainState.cue_channels = cueChannels;
+            } else {
+                daisyRelayCue(chainState, msgFromModule, msgToModule);
+            }
+            msgToModule->chain = chainState;
+
+            // Get the return message coming back from the master
+            returnMessage = *(DaisyReturnMessage *)(rightExpander.consumerMessage);
+
             for (int c = 0; c < chainChannels; c++) {
                 msgToModule->voltages_l[c] = signals_l[c];
                 msgToModule->voltages_r[c] = signals_r[c];
@@ -140,22 +190,28 @@ struct DaisyChannelSends3 : Module {
             link_r = 0.0f;
         }
 
-        // Bring the voltage back up from the chained low voltage
-        for (int c = 0; c < chainChannels; c++) {
-            mix_l[c] = clamp(mix_l[c] * DAISY_DIVISOR, -12.f, 12.f) * 1;
-            mix_r[c] = clamp(mix_r[c] * DAISY_DIVISOR, -12.f, 12.f) * 1;
-            signals_l[c] = clamp(signals_l[c] * DAISY_DIVISOR, -12.f, 12.f) * 1;
-            signals_r[c] = clamp(signals_r[c] * DAISY_DIVISOR, -12.f, 12.f) * 1;
+        // Only decode the aux bus if it is patched or a return on the right sends it
+        bool outputsConnected = outputs[CH_OUTPUT_1].isConnected() || outputs[CH_OUTPUT_2].isConnected();
+        bool auxNeeded = link_r > 0.f && returnMessage.needs_single && returnMessage.needs_aux;
+
+        // Apply the headroom policy to the aux bus leaving the chain
+        if (headroom != DAISY_HEADROOM_NONE && (outputsConnected || auxNeeded)) {
+            for (int c = 0; c < chainChannels; c++) {
+                mix_l[c] = daisyHeadroom(mix_l[c], headroom);
+                mix_r[c] = daisyHeadroom(mix_r[c], headroom);
+            }
         }
 
-        // Set daisy-chained output to right-side linked module
-        if (rightExpander.module && rightExpander.module->model == modelDaisyChannelVu) {
-            // Write this module's output to the producer message
+        // Set daisy-chained output to right-side linked module, if a module on the right reads it
+        if (link_r > 0.f && returnMessage.needs_single) {
+            // Write this module's output to the producer message, or the aux bus for a return
             DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
+            const float *single_l = auxNeeded ? mix_l : signals_l;
+            const float *single_r = auxNeeded ? mix_r : signals_r;
             msgToModule->single_channels = chainChannels;
             for (int c = 0; c < chainChannels; c++) {
-                msgToModule->single_voltages_l[c] = signals_l[c];
-                msgToModule->single_voltages_r[c] = signals_r[c];
+                msgToModule->single_voltages_l[c] = single_l[c];
+                msgToModule->single_voltages_r[c] = single_r[c];
             }
         }
 
@@ -164,14 +220,27 @@ struct DaisyChannelSends3 : Module {
         }
 
         // Set aggregated decoded output
-        outputs[CH_OUTPUT_1].setChannels(chainChannels);
-        outputs[CH_OUTPUT_1].writeVoltages(mix_l);
-        outputs[CH_OUTPUT_2].setChannels(chainChannels);
-        outputs[CH_OUTPUT_2].writeVoltages(mix_r);
+        if (outputsConnected) {
+            outputs[CH_OUTPUT_1].setChannels(chainChannels);
+            outputs[CH_OUTPUT_1].writeVoltages(mix_l);
+            outputs[CH_OUTPUT_2].setChannels(chainChannels);
+            outputs[CH_OUTPUT_2].writeVoltages(mix_r);
+        }
+
+        // Pass the return message on to the left-side linked module, with this module's demand for single voltages
+        if (link_l > 0.f) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            returnToModule->needs_single = false;
+            returnToModule->needs_aux = false;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
 
         // Set lights
         if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
             lights[MUTE_LIGHT].value = (muted);
+            lights[CUE_LIGHT].setBrightness(cued);
             lights[LINK_LIGHT_L].setBrightness(link_l);
             lights[LINK_LIGHT_R].setBrightness(link_r);
         }
@@ -195,6 +264,9 @@ struct DaisyChannelSendsWidget3 : ModuleWidget {
         // Mute
         addParam(createLightParam<VCVLightLatch<MediumSimpleLight<RedLight>>>(Vec(RACK_GRID_WIDTH - 9.0, 254.0), module, DaisyChannelSends3::MUTE_PARAM, DaisyChannelSends3::MUTE_LIGHT));
 
+        // Cue
+        addParam(createLightParam<VCVLightLatch<MediumSimpleLight<GreenLight>>>(Vec(RACK_GRID_WIDTH - 9.0, 60.0), module, DaisyChannelSends3::CUE_PARAM, DaisyChannelSends3::CUE_LIGHT));
+
         // Link lights
         addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH - 4, 361.0f), module, DaisyChannelSends3::LINK_LIGHT_L));
         addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH + 4, 361.0f), module, DaisyChannelSends3::LINK_LIGHT_R));
@@ -204,6 +276,13 @@ struct DaisyChannelSendsWidget3 : ModuleWidget {
         addParam(createParam<LEDSliderGreen>(Vec(RACK_GRID_WIDTH - 10.5, 138.4), module, DaisyChannelSends3::CH_LVL_PARAM));
         addParam(createParamCentered<Trimpot>(Vec(RACK_GRID_WIDTH - 0, 240.0), module, DaisyChannelSends3::PAN_PARAM));
     }
+
+    void appendContextMenu(Menu *menu) override {
+        DaisyChannelSends3 *module = dynamic_cast<DaisyChannelSends3 *>(this->module);
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createIndexPtrSubmenuItem("Headroom", {"Clip at 12V", "Soft clip", "Unlimited"}, &module->headroom));
+    }
 };
 
 Model *modelDaisyChannelSends3 = createModel<DaisyChannelSends3, DaisyChannelSendsWidget3>("DaisyChannelSends3");
@@ -1,5 +1,7 @@
 #include "QuantalAudioExtendedMixer.hpp"
 #include "Daisy.hpp"
+#include "DaisyMath.hpp"
+#include "DaisyGovernor.hpp"
 
 static const int VU_LIGHT_COUNT = 32;
 
@@ -34,10 +36,14 @@ struct DaisyChannelVu : Module {
     float link_r = 0.f;
 
     dsp::ClockDivider lightDivider;
+    dsp::ClockDivider meterDivider;
     dsp::VuMeter2 vuMeter[2];
 
+    // Peak since the last meter update, which the governor spaces out under load
+    float meterPeak[2] = {};
+
     DaisyMessage daisyInputMessage[2][1];
-    DaisyMessage daisyOutputMessage[2][1];
+    DaisyReturnMessage daisyReturnMessage[2][1];
 
     DaisyChannelVu() {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -48,8 +54,8 @@ struct DaisyChannelVu : Module {
         // Set the expander messages
         leftExpander.producerMessage = &daisyInputMessage[0];
         leftExpander.consumerMessage = &daisyInputMessage[1];
-        rightExpander.producerMessage = &daisyOutputMessage[0];
-        rightExpander.consumerMessage = &daisyOutputMessage[1];
+        rightExpander.producerMessage = &daisyReturnMessage[0];
+        rightExpander.consumerMessage = &daisyReturnMessage[1];
 
         lightDivider.setDivision(512);
     }
@@ -61,6 +67,8 @@ struct DaisyChannelVu : Module {
         float daisySignals_l[16] = {};
         float daisySignals_r[16] = {};
         int chainChannels = 1;
+        DaisyChainState chainState;
+        DaisyReturnMessage returnMessage;
 
         // Get daisy-chained data from left-side linked module
         if (leftExpander.module && (
@@ -71,9 +79,14 @@ struct DaisyChannelVu : Module {
             || leftExpander.module->model == modelDaisyMaster2
             || leftExpander.module->model == modelDaisyBlank1
             || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
             chainChannels = msgFromModule->channels;
+            chainState = msgFromModule->chain;
             for (int c = 0; c < chainChannels; c++) {
                 daisySignals_l[c] = msgFromModule->voltages_l[c];
                 daisySignals_r[c] = msgFromModule->voltages_r[c];
@@ -84,16 +97,23 @@ struct DaisyChannelVu : Module {
                 signals_l[c] = msgFromModule->single_voltages_l[c];
                 signals_r[c] = msgFromModule->single_voltages_r[c];
             }
-            vuMeter[0].process(args.sampleTime, _getVoltageSum(chainChannels, signals_l) / 10.f);
-            vuMeter[1].process(args.sampleTime, _getVoltageSum(chainChannels, signals_r) / 10.f);
+            meterPeak[0] = std::max(meterPeak[0], std::fabs(_getVoltageSum(chainChannels, signals_l) / 10.f));
+            meterPeak[1] = std::max(meterPeak[1], std::fabs(_getVoltageSum(chainChannels, signals_r) / 10.f));
 
             link_l = 0.8f;
         } else {
-            vuMeter[0].process(args.sampleTime, 0.0f);
-            vuMeter[1].process(args.sampleTime, 0.0f);
             link_l = 0.0f;
         }
 
+        if (meterDivider.process()) {
+            float deltaTime = args.sampleTime * meterDivider.getDivision();
+            vuMeter[0].process(deltaTime, meterPeak[0]);
+            vuMeter[1].process(deltaTime, meterPeak[1]);
+            meterPeak[0] = 0.f;
+            meterPeak[1] = 0.f;
+            meterDivider.setDivision(daisyGovernor.getMeterDivision());
+        }
+
         // Set daisy-chained output to right-side linked module
         if (rightExpander.module && (
             rightExpander.module->model == modelDaisyMaster2
@@ -103,10 +123,20 @@ struct DaisyChannelVu : Module {
             || rightExpander.module->model == modelDaisyChannelSends3
             || rightExpander.module->model == modelDaisyBlank1
             || rightExpander.module->model == modelDaisyBlank2
+            || rightExpander.module->model == modelDaisyChannelDynamics
+            || rightExpander.module->model == modelDaisyAnalyzer
+            || rightExpander.module->model == modelDaisyReverb
+            || rightExpander.module->model == modelDaisyMatrix
         )) {
             DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
 
             msgToModule->channels = chainChannels;
+            msgToModule->chain = chainState;
+            daisyRelayCue(chainState, (DaisyMessage *)(leftExpander.consumerMessage), msgToModule);
+
+            // Get the return message coming back from the master
+            returnMessage = *(DaisyReturnMessage *)(rightExpander.consumerMessage);
+
             for (int c = 0; c < chainChannels; c++) {
                 msgToModule->voltages_l[c] = daisySignals_l[c];
                 msgToModule->voltages_r[c] = daisySignals_r[c];
@@ -119,11 +149,24 @@ struct DaisyChannelVu : Module {
             link_r = 0.0f;
         }
 
+        // Pass the return message on to the left-side linked module, with this module's demand for single voltages
+        if (link_l > 0.f && leftExpander.module->model != modelDaisyMaster2) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            returnToModule->needs_single = true;
+            returnToModule->needs_aux = false;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
+
         // Set lights
         if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
+            // One level conversion per side rather than one per segment
+            float db_l = daisyAmplitudeToDb(vuMeter[0].v);
+            float db_r = daisyAmplitudeToDb(vuMeter[1].v);
             for (int i = VU_LIGHT_COUNT + 8 + 3; i >= 0; i--) {
-                lights[VU_LIGHTS_L + i].setBrightness(vuMeter[0].getBrightness(-60.f + 1.5f * i + 1, -60 + 1.5f * i));
-                lights[VU_LIGHTS_R + i].setBrightness(vuMeter[1].getBrightness(-60.f + 1.5f * i + 1, -60 + 1.5f * i));
+                lights[VU_LIGHTS_L + i].setBrightness(daisyMeterBrightness(db_l, -60.f + 1.5f * i + 1, -60 + 1.5f * i));
+                lights[VU_LIGHTS_R + i].setBrightness(daisyMeterBrightness(db_r, -60.f + 1.5f * i + 1, -60 + 1.5f * i));
             }
             lights[LINK_LIGHT_L].setBrightness(link_l);
             lights[LINK_LIGHT_R].setBrightness(link_r);
@@ -0,0 +1,100 @@
+#include "QuantalAudioExtendedMixer.hpp"
+#include "DaisyDelay.hpp"
+
+DaisyDelayArena daisyDelayArena;
+
+DaisyDelayArena::DaisyDelayArena() {
+    for (int order = 0; order <= DAISY_ARENA_ORDER; order++) {
+        freeHead[order] = -1;
+    }
+    for (int i = 0; i < DAISY_ARENA_BLOCKS; i++) {
+        blockFree[i] = false;
+    }
+}
+
+void DaisyDelayArena::prepare() {
+    if (prepared) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(prepareMutex);
+    if (prepared) {
+        return;
+    }
+
+    // Write through the whole region now, so the audio thread never takes a first-touch page fault
+    float *region = (float *)std::malloc(sizeof(float) << DAISY_ARENA_ORDER);
+    if (!region) {
+        return;
+    }
+    std::memset(region, 0, sizeof(float) << DAISY_ARENA_ORDER);
+
+    lock();
+    memory = region;
+    push(0, DAISY_ARENA_ORDER);
+    unlock();
+    prepared = true;
+}
+
+void DaisyDelayArena::push(int index, int order) {
+    blockOrder[index] = order;
+    blockFree[index] = true;
+    prevFree[index] = -1;
+    nextFree[index] = freeHead[order];
+    if (freeHead[order] >= 0) {
+        prevFree[freeHead[order]] = index;
+    }
+    freeHead[order] = index;
+}
+
+void DaisyDelayArena::remove(int index, int order) {
+    blockFree[index] = false;
+    if (prevFree[index] >= 0) {
+        nextFree[prevFree[index]] = nextFree[index];
+    } else {
+        freeHead[order] = nextFree[index];
+    }
+    if (nextFree[index] >= 0) {
+        prevFree[nextFree[index]] = prevFree[index];
+    }
+}
+
+float *DaisyDelayArena::allocate(int order) {
+    order = std::max(order, DAISY_ARENA_MIN_ORDER);
+
+    int from = order;
+    while (from <= DAISY_ARENA_ORDER && freeHead[from] < 0) {
+        from++;
+    }
+    if (from > DAISY_ARENA_ORDER) {
+        return NULL;
+    }
+
+    int index = freeHead[from];
+    remove(index, from);
+
+    // Split, putting the upper halves back on the free lists
+    while (from > order) {
+        from--;
+        push(index + (1 << (from - DAISY_ARENA_MIN_ORDER)), from);
+    }
+    blockOrder[index] = order;
+
+    return memory + ((size_t)index << DAISY_ARENA_MIN_ORDER);
+}
+
+void DaisyDelayArena::free(float *block) {
+    int index = (block - memory) >> DAISY_ARENA_MIN_ORDER;
+    int order = blockOrder[index];
+
+    // Merge with free buddies of the same size
+    while (order < DAISY_ARENA_ORDER) {
+        int buddy = index ^ (1 << (order - DAISY_ARENA_MIN_ORDER));
+        if (!blockFree[buddy] || blockOrder[buddy] != order) {
+            break;
+        }
+        remove(buddy, order);
+        index = std::min(index, buddy);
+        order++;
+    }
+    push(index, order);
+}
@@ -0,0 +1,295 @@
+#if !defined(DAISY_DELAY_H)
+#define DAISY_DELAY_H 1
+
+#include <mutex>
+#include <thread>
+
+// Smallest and whole arena block sizes, as powers of two of floats
+const int DAISY_ARENA_MIN_ORDER = 10;
+const int DAISY_ARENA_ORDER = 23;
+const int DAISY_ARENA_BLOCKS = 1 << (DAISY_ARENA_ORDER - DAISY_ARENA_MIN_ORDER);
+
+// Floats a delay line moves into a new block per control block while it resizes
+const int DAISY_DELAY_MIGRATE_FLOATS = 16384;
+
+/**
+ * Plugin-wide delay memory: one region allocated and written through by
+ * prepare() the first time a strip asks for a delay, handed out in
+ * power-of-two blocks by a buddy allocator. Nothing the audio thread calls
+ * touches the heap or faults in pages. The audio thread only ever
+ * try-locks, so a strip that loses the race, or asks before the region is
+ * ready, simply asks again on its next control block.
+ */
+struct DaisyDelayArena {
+    float *memory = NULL;
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+
+    // Free lists per order, linked through the index of each block's first min-block
+    int freeHead[DAISY_ARENA_ORDER + 1];
+    int nextFree[DAISY_ARENA_BLOCKS];
+    int prevFree[DAISY_ARENA_BLOCKS];
+    int8_t blockOrder[DAISY_ARENA_BLOCKS];
+    bool blockFree[DAISY_ARENA_BLOCKS];
+
+    std::atomic<bool> prepared {false};
+    std::mutex prepareMutex;
+
+    DaisyDelayArena();
+
+    /** Allocates the region if it isn't yet, never from the audio thread. */
+    void prepare();
+
+    bool tryLock() {
+        return !busy.test_and_set(std::memory_order_acquire);
+    }
+
+    /** Waits for the lock, never from the audio thread. */
+    void lock() {
+        while (busy.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock() {
+        busy.clear(std::memory_order_release);
+    }
+
+    /** Returns a block of 2^order floats, not cleared, or NULL if the arena is full. Call with the lock held. */
+    float *allocate(int order);
+
+    /** Returns a block to the arena. Call with the lock held. */
+    void free(float *block);
+
+private:
+    void push(int index, int order);
+    void remove(int index, int order);
+};
+
+extern DaisyDelayArena daisyDelayArena;
+
+/** 4-point, 3rd-order Hermite interpolation between x0 and x1. */
+inline float daisyHermite(float xm1, float x0, float x1, float x2, float t) {
+    float c = (x1 - xm1) * 0.5f;
+    float v = x0 - x1;
+    float w = c + v;
+    float a = w + v + (x2 - x0) * 0.5f;
+    float b = w + a;
+    return ((a * t - b) * t + c) * t + x0;
+}
+
+/**
+ * A delay line for up to 16 stereo voices in an arena block. Frames are
+ * interleaved with a power-of-two stride, so ring indexing is a mask.
+ *
+ * Growing the line fills the new block a bounded slice per control block,
+ * the recent history first, while the old block stays in use; both blocks
+ * take new frames until the new one is complete and swapped in.
+ */
+struct DaisyDelayLine {
+    float *buffer = NULL;
+    int frames = 0;
+    int stride = 0;
+    uint32_t writeIndex = 0;
+
+    // The block being filled, and how far along it is
+    float *pending = NULL;
+    int pendingFrames = 0;
+    int pendingStride = 0;
+    int pendingKeep = 0;
+    int pendingStep = 0;
+    uint32_t pendingStart = 0;
+
+    // Set when the arena couldn't fit the delay asked for, reads are clamped to the current block
+    bool starved = false;
+
+    /** Largest delay in samples the current block can read. */
+    float getMaxDelay() const {
+        return buffer ? frames - 4 : 0.f;
+    }
+
+    /**
+     * Makes room for a delay of the given samples and voices, keeping the
+     * recent history. Called at control rate; if the arena is busy the old
+     * block stays in use and the next call tries again.
+     */
+    void reserve(float delay, int channels) {
+        if (pending) {
+            migrate();
+            return;
+        }
+
+        int needStride = 2;
+        while (needStride < 2 * channels) {
+            needStride *= 2;
+        }
+        int needFrames = 16;
+        while (needFrames < (int)delay + 4) {
+            needFrames *= 2;
+        }
+
+        // Keep blocks that fit, unless one under a quarter of the size would do
+        if (buffer && needStride <= stride && needFrames <= frames && needFrames * 4 > frames) {
+            starved = false;
+            return;
+        }
+        needStride = std::max(needStride, stride);
+
+        int order = DAISY_ARENA_MIN_ORDER;
+        while ((1 << order) < needFrames * needStride) {
+            order++;
+        }
+        if (order > DAISY_ARENA_ORDER) {
+            starved = true;
+            return;
+        }
+        if (!daisyDelayArena.tryLock()) {
+            return;
+        }
+        float *block = daisyDelayArena.allocate(order);
+        daisyDelayArena.unlock();
+        // Before the region is prepared the strip just waits, it isn't short of memory
+        starved = !block && daisyDelayArena.prepared;
+        if (!block) {
+            return;
+        }
+
+        pending = block;
+        pendingStride = needStride;
+        pendingFrames = (1 << order) / needStride;
+        pendingKeep = buffer ? std::min(frames, pendingFrames) : 0;
+        pendingStep = 0;
+        pendingStart = writeIndex;
+        migrate();
+    }
+
+    /**
+     * Fills the next slice of the pending block: the kept history oldest
+     * first, so each frame is copied before the old ring overwrites it, then
+     * silence for the rest. Swaps the block in once it is complete. The
+     * slice covers at least a control block's worth of frames, so the copy
+     * keeps ahead of the writes.
+     */
+    void migrate() {
+        int budget = std::max(DAISY_DELAY_MIGRATE_FLOATS / pendingStride, 32);
+        uint32_t elapsed = writeIndex - pendingStart;
+        for (; budget > 0 && pendingStep < pendingFrames; budget--, pendingStep++) {
+            // Age of the frame relative to where the resize started, 0 is the newest
+            bool keep = pendingStep < pendingKeep;
+            int age = keep ? pendingKeep - 1 - pendingStep : pendingFrames - 1 - (pendingStep - pendingKeep);
+
+            // The slot already holds a frame written since
+            if (age + elapsed >= (uint32_t)pendingFrames) {
+                continue;
+            }
+
+            uint32_t i = pendingStart - age;
+            float *to = &pending[(i & (pendingFrames - 1)) * pendingStride];
+            std::fill(to, to + pendingStride, 0.f);
+
+            // Unless the old ring has moved past it while the resize was stalled
+            if (keep && age + elapsed < (uint32_t)frames) {
+                const float *from = &buffer[(i & (frames - 1)) * stride];
+                int half = stride / 2;
+                std::copy(from, from + half, to);
+                std::copy(from + half, from + stride, to + pendingStride / 2);
+            }
+        }
+        if (pendingStep < pendingFrames) {
+            return;
+        }
+
+        if (buffer) {
+            if (!daisyDelayArena.tryLock()) {
+                return;
+            }
+            daisyDelayArena.free(buffer);
+            daisyDelayArena.unlock();
+        }
+        buffer = pending;
+        frames = pendingFrames;
+        stride = pendingStride;
+        pending = NULL;
+    }
+
+    /** Hands the blocks back to the arena, from the audio thread. */
+    void release() {
+        if ((buffer || pending) && daisyDelayArena.tryLock()) {
+            if (buffer) {
+                daisyDelayArena.free(buffer);
+            }
+            if (pending) {
+                daisyDelayArena.free(pending);
+            }
+            daisyDelayArena.unlock();
+            buffer = NULL;
+            pending = NULL;
+            frames = 0;
+        }
+    }
+
+    /** Hands the blocks back to the arena, from a module destructor. */
+    void destroy() {
+        if (buffer || pending) {
+            daisyDelayArena.lock();
+            if (buffer) {
+                daisyDelayArena.free(buffer);
+            }
+            if (pending) {
+                daisyDelayArena.free(pending);
+            }
+            daisyDelayArena.unlock();
+            buffer = NULL;
+            pending = NULL;
+            frames = 0;
+        }
+    }
+
+    /** Writes a frame, clearing the lanes past the given voices as blocks are not cleared up front. */
+    void write(const float *l, const float *r, int channels) {
+        writeIndex++;
+        writeFrame(&buffer[(writeIndex & (frames - 1)) * stride], stride, l, r, channels);
+        if (pending) {
+            writeFrame(&pending[(writeIndex & (pendingFrames - 1)) * pendingStride], pendingStride, l, r, channels);
+        }
+    }
+
+    /**
+     * Reads voice c of side 0 (left) or 1 (right). Under 1 sample it blends
+     * toward the frame just written, so a delay of 0 passes the input as is.
+     */
+    float read(int c, int side, float delay) const {
+        delay = clamp(delay, 0.f, getMaxDelay());
+        int n = (int)delay;
+        float t = delay - n;
+        int offset = side * stride / 2 + c;
+        uint32_t mask = frames - 1;
+        uint32_t i = writeIndex - n;
+        if (n == 0) {
+            float x0 = buffer[(i & mask) * stride + offset];
+            float x1 = buffer[((i - 1) & mask) * stride + offset];
+            return x0 + (x1 - x0) * t;
+        }
+        return daisyHermite(
+            buffer[((i + 1) & mask) * stride + offset],
+            buffer[(i & mask) * stride + offset],
+            buffer[((i - 1) & mask) * stride + offset],
+            buffer[((i - 2) & mask) * stride + offset],
+            t);
+    }
+
+private:
+    static void writeFrame(float *frame, int frameStride, const float *l, const float *r, int channels) {
+        int half = frameStride / 2;
+        channels = std::min(channels, half);
+        for (int c = 0; c < channels; c++) {
+            frame[c] = l[c];
+            frame[half + c] = r[c];
+        }
+        for (int c = channels; c < half; c++) {
+            frame[c] = 0.f;
+            frame[half + c] = 0.f;
+        }
+    }
+};
+
+#endif
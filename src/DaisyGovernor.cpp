@@ -0,0 +1,22 @@
+#include "QuantalAudioExtendedMixer.hpp"
+#include "DaisyGovernor.hpp"
+
+DaisyGovernor daisyGovernor;
+
+json_t *DaisyGovernor::toJson() {
+    json_t *governorJ = json_object();
+    json_object_set_new(governorJ, "enabled", json_boolean(enabled));
+    json_object_set_new(governorJ, "reduceLoad", json_real(reduceLoad));
+    json_object_set_new(governorJ, "restoreLoad", json_real(restoreLoad));
+    return governorJ;
+}
+
+void DaisyGovernor::fromJson(json_t *governorJ) {
+    if (!governorJ) {
+        return;
+    }
+    enabled = json_is_true(json_object_get(governorJ, "enabled"));
+    setThresholds(
+        json_number_value(json_object_get(governorJ, "reduceLoad")),
+        json_number_value(json_object_get(governorJ, "restoreLoad")));
+}
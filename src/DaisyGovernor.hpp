@@ -0,0 +1,108 @@
+#if !defined(DAISY_GOVERNOR_H)
+#define DAISY_GOVERNOR_H 1
+
+// Quality steps for metering and analysis, stepped down as the engine load rises
+enum DaisyQuality {
+    DAISY_QUALITY_FULL,
+    DAISY_QUALITY_REDUCED,
+    DAISY_QUALITY_MINIMAL,
+    DAISY_QUALITY_COUNT
+};
+
+// Engine load thresholds offered in the master's context menu
+const int DAISY_GOVERNOR_LOAD_COUNT = 6;
+const float DAISY_GOVERNOR_LOADS[DAISY_GOVERNOR_LOAD_COUNT] = {0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f};
+
+/**
+ * Plugin-wide CPU governor. Every module polls it from its light divider;
+ * the first poll in each interval reads the engine meter, the rest return at
+ * once. Only lights, meters and analysis read the quality, never the mix.
+ */
+struct DaisyGovernor {
+    std::atomic<bool> enabled {true};
+    std::atomic<float> reduceLoad {0.8f};
+    std::atomic<float> restoreLoad {0.6f};
+    std::atomic<int> quality {DAISY_QUALITY_FULL};
+
+    std::atomic<int64_t> lastFrame {0};
+
+    // Smoothed load and the time it has sat past a threshold, written by the poller, read by the menu
+    std::atomic<float> load {0.f};
+    std::atomic<float> overTime {0.f};
+    std::atomic<float> underTime {0.f};
+
+    void update(const Module::ProcessArgs &args) {
+        // Poll the engine meter every 50 ms at most, whichever module gets there first
+        int64_t last = lastFrame.load(std::memory_order_relaxed);
+        int64_t elapsed = args.frame - last;
+        if (elapsed >= 0 && elapsed < (int64_t)(args.sampleRate * 0.05f)) {
+            return;
+        }
+        if (!lastFrame.compare_exchange_strong(last, args.frame, std::memory_order_relaxed)) {
+            return;
+        }
+        float dt = clamp(elapsed * args.sampleTime, 0.f, 1.f);
+
+        if (!enabled) {
+            quality = DAISY_QUALITY_FULL;
+            overTime = underTime = 0.f;
+            return;
+        }
+
+        load = load + (APP->engine->getMeterAverage() - load) * 0.5f;
+
+        // Give way quickly, come back slowly
+        int q = quality;
+        overTime = load > reduceLoad ? overTime + dt : 0.f;
+        underTime = load < restoreLoad ? underTime + dt : 0.f;
+        if (overTime >= 0.25f && q < DAISY_QUALITY_MINIMAL) {
+            quality = q + 1;
+            overTime = 0.f;
+        } else if (underTime >= 2.f && q > DAISY_QUALITY_FULL) {
+            quality = q - 1;
+            underTime = 0.f;
+        }
+    }
+
+    /** Light divider division at the current quality: 512, 2048 or 8192 samples. */
+    int getLightDivision() const {
+        return 512 << (2 * quality);
+    }
+
+    /** Samples per meter update at the current quality: 1, 4 or 16. */
+    int getMeterDivision() const {
+        return 1 << (2 * quality);
+    }
+
+    /** Keeps restore below reduce, so the two cannot fight. */
+    void setThresholds(float reduce, float restore) {
+        reduce = clamp(reduce, DAISY_GOVERNOR_LOADS[1], DAISY_GOVERNOR_LOADS[DAISY_GOVERNOR_LOAD_COUNT - 1]);
+        reduceLoad = reduce;
+        restoreLoad = clamp(restore, DAISY_GOVERNOR_LOADS[0], reduce - 0.1f);
+    }
+
+    // Saved in the plugin settings rather than a patch, since every module shares it
+    json_t *toJson();
+    void fromJson(json_t *governorJ);
+};
+
+extern DaisyGovernor daisyGovernor;
+
+/** Index of the menu threshold nearest to a load. */
+inline size_t daisyGovernorLoadIndex(float load) {
+    size_t nearest = 0;
+    for (int i = 1; i < DAISY_GOVERNOR_LOAD_COUNT; i++) {
+        if (std::fabs(DAISY_GOVERNOR_LOADS[i] - load) < std::fabs(DAISY_GOVERNOR_LOADS[nearest] - load)) {
+            nearest = i;
+        }
+    }
+    return nearest;
+}
+
+/** Polls the governor from a module's light divider and rescales the divider to match. */
+inline void daisyGovernLights(dsp::ClockDivider &lightDivider, const Module::ProcessArgs &args) {
+    daisyGovernor.update(args);
+    lightDivider.setDivision(daisyGovernor.getLightDivision());
+}
+
+#endif
@@ -1,30 +1,79 @@
 #include "QuantalAudioExtendedMixer.hpp"
 #include "Daisy.hpp"
+#include "DaisyAutomation.hpp"
+#include "DaisyGovernor.hpp"
 
 struct DaisyMaster2 : Module {
     enum ParamIds {
         MIX_LVL_PARAM,
         MUTE_PARAM,
+        SCENE_PARAM,
+        SCENE_ENABLE_PARAM,
         NUM_PARAMS
     };
     enum InputIds {
         MIX_CV_INPUT,
+        CLOCK_INPUT,
+        RESET_INPUT,
         NUM_INPUTS
     };
     enum OutputIds {
         MIX_OUTPUT_1, // Left
         MIX_OUTPUT_2, // Right
+        CUE_OUTPUT_1, // Left
+        CUE_OUTPUT_2, // Right
         NUM_OUTPUTS
     };
     enum LightsIds {
         MUTE_LIGHT,
         LINK_LIGHT_L,
+        ENUMS(AUTOMATION_LIGHT, 2),
+        CUE_LIGHT,
         NUM_LIGHTS
     };
 
     bool muted = false;
+    int headroom = DAISY_HEADROOM_CLIP;
+    bool cueActive = false;
     float link_l = 0.f;
     dsp::ClockDivider lightDivider;
+    dsp::ClockDivider controlDivider;
+
+    // Scene table, states[i] is the i-th channel strip from the left
+    struct Scene {
+        int strips = 0;
+        DaisyStripState states[DAISY_MAX_STRIPS];
+    };
+    Scene scenes[DAISY_SCENES];
+
+    // Latest settings reported by each strip in the chain
+    DaisyStripState stripStates[DAISY_MAX_STRIPS];
+    int chainStrips = 0;
+    int reportCursor = 0;
+    int syncScene = 0;
+    int syncStrip = 0;
+    std::atomic<int> captureRequest {-1};
+
+    // Gain-sharing automix, the strips' power total as it arrives
+    bool automix = false;
+    float automixPower = 0.f;
+    int automixStrips = 0;
+
+    // Automation transport, free-running at 100 ticks per second without a clock
+    int automation = DAISY_AUTOMATION_OFF;
+    dsp::SchmittTrigger clockTrigger;
+    dsp::SchmittTrigger resetTrigger;
+    bool clockStarted = false;
+    int clockTicks = 0;
+    float clockPeriod = 0.f;
+    float samplesSinceClock = 0.f;
+
+    // The master level lane
+    DaisyAutomationLane levelLane;
+    bool levelRecording = false;
+    std::atomic<bool> clearAutomation {false};
+
+    DaisyReturnMessage returnMessage;
 
     DaisyMessage daisyMessages[2][1];
 
@@ -32,18 +81,27 @@ struct DaisyMaster2 : Module {
         config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
         configParam(MIX_LVL_PARAM, 0.0f, 2.0f, 1.0f, "Mix level", " dB", -10, 20);
         configSwitch(MUTE_PARAM, 0.f, 1.f, 0.f, "Mute", {"Not muted", "Muted"});
+        configParam(SCENE_PARAM, 0.f, DAISY_SCENES - 1, 0.f, "Scene morph", "", 0.f, 1.f, 1.f);
+        configSwitch(SCENE_ENABLE_PARAM, 0.f, 1.f, 0.f, "Scenes", {"Off", "On"});
 
         configInput(MIX_CV_INPUT, "Level CV");
+        configInput(CLOCK_INPUT, "Automation clock");
+        configInput(RESET_INPUT, "Automation reset");
         configOutput(MIX_OUTPUT_1, "Mix L");
         configOutput(MIX_OUTPUT_2, "Mix R");
+        configOutput(CUE_OUTPUT_1, "Cue L");
+        configOutput(CUE_OUTPUT_2, "Cue R");
 
         configLight(LINK_LIGHT_L, "Daisy chain link input");
+        configLight(AUTOMATION_LIGHT, "Automation playing (green) or recording (red)");
+        configLight(CUE_LIGHT, "Cue output follows the cued strips");
 
         // Set the left expander message instances
         leftExpander.producerMessage = &daisyMessages[0];
         leftExpander.consumerMessage = &daisyMessages[1];
 
         lightDivider.setDivision(512);
+        controlDivider.setDivision(32);
     }
 
     json_t *dataToJson() override {
@@ -52,6 +110,31 @@ struct DaisyMaster2 : Module {
         // mute
         json_object_set_new(rootJ, "muted", json_boolean(muted));
 
+        // headroom
+        json_object_set_new(rootJ, "headroom", json_integer(headroom));
+
+        // scenes
+        json_t *scenesJ = json_array();
+        for (int i = 0; i < DAISY_SCENES; i++) {
+            json_t *sceneJ = json_array();
+            for (int s = 0; s < scenes[i].strips; s++) {
+                json_t *stateJ = json_array();
+                json_array_append_new(stateJ, json_real(scenes[i].states[s].level));
+                json_array_append_new(stateJ, json_real(scenes[i].states[s].pan));
+                json_array_append_new(stateJ, json_boolean(scenes[i].states[s].muted));
+                json_array_append_new(sceneJ, stateJ);
+            }
+            json_array_append_new(scenesJ, sceneJ);
+        }
+        json_object_set_new(rootJ, "scenes", scenesJ);
+
+        // automix
+        json_object_set_new(rootJ, "automix", json_boolean(automix));
+
+        // automation
+        json_object_set_new(rootJ, "automation", json_integer(automation));
+        json_object_set_new(rootJ, "levelLane", levelLane.toJson());
+
         return rootJ;
     }
 
@@ -60,6 +143,145 @@ struct DaisyMaster2 : Module {
         json_t *mutedJ = json_object_get(rootJ, "muted");
         if (mutedJ)
             muted = json_is_true(mutedJ);
+
+        // headroom, patches from before the unscaled bus clip at 12V
+        json_t *headroomJ = json_object_get(rootJ, "headroom");
+        if (headroomJ)
+            headroom = clamp((int)json_integer_value(headroomJ), 0, DAISY_HEADROOM_COUNT - 1);
+
+        // scenes
+        json_t *scenesJ = json_object_get(rootJ, "scenes");
+        if (scenesJ) {
+            for (int i = 0; i < DAISY_SCENES; i++) {
+                json_t *sceneJ = json_array_get(scenesJ, i);
+                int strips = sceneJ ? std::min((int)json_array_size(sceneJ), DAISY_MAX_STRIPS) : 0;
+                for (int s = 0; s < strips; s++) {
+                    json_t *stateJ = json_array_get(sceneJ, s);
+                    scenes[i].states[s].level = json_number_value(json_array_get(stateJ, 0));
+                    scenes[i].states[s].pan = json_number_value(json_array_get(stateJ, 1));
+                    scenes[i].states[s].muted = json_is_true(json_array_get(stateJ, 2));
+                }
+                scenes[i].strips = strips;
+            }
+        }
+
+        // automix
+        json_t *automixJ = json_object_get(rootJ, "automix");
+        if (automixJ)
+            automix = json_is_true(automixJ);
+
+        // automation
+        json_t *automationJ = json_object_get(rootJ, "automation");
+        if (automationJ)
+            automation = clamp((int)json_integer_value(automationJ), 0, DAISY_AUTOMATION_RECORD);
+        levelLane.fromJson(json_object_get(rootJ, "levelLane"));
+    }
+
+    /** Stores the strips' current settings in a scene slot, safe to call from the UI thread. */
+    void captureScene(int scene) {
+        captureRequest = scene;
+    }
+
+    /** Works out which scenes the strips should morph between, called at control rate. */
+    void updateSceneMorph() {
+        float position = clamp(params[SCENE_PARAM].getValue(), 0.f, (float)(DAISY_SCENES - 1));
+
+        int a = (int)position;
+        int b = std::min(a + 1, DAISY_SCENES - 1);
+        float morph = position - a;
+
+        // Empty slots snap to the nearest captured neighbour, so a lone scene recalls on its own
+        if (scenes[b].strips == 0) {
+            b = a;
+            morph = 0.f;
+        }
+        if (scenes[a].strips == 0) {
+            a = b;
+            morph = 0.f;
+        }
+
+        returnMessage.scene_active = params[SCENE_ENABLE_PARAM].getValue() > 0.f && scenes[a].strips > 0;
+        returnMessage.scene_a = a;
+        returnMessage.scene_b = b;
+        returnMessage.scene_morph = morph;
+    }
+
+    /** Picks the strip to report and the scene entry to send upstream this sample. */
+    void updateSceneTraffic() {
+        if (chainStrips == 0) {
+            returnMessage.report_strip = -1;
+            returnMessage.sync_strip = -1;
+            return;
+        }
+
+        reportCursor = (reportCursor + 1) % chainStrips;
+        returnMessage.report_strip = reportCursor;
+
+        if (++syncStrip >= chainStrips) {
+            syncStrip = 0;
+            syncScene = (syncScene + 1) % DAISY_SCENES;
+        }
+        const Scene &scene = scenes[syncScene];
+        returnMessage.sync_strip = syncStrip;
+        returnMessage.sync_scene = syncScene;
+        returnMessage.sync_valid = syncStrip < scene.strips;
+        if (returnMessage.sync_valid) {
+            returnMessage.sync = scene.states[syncStrip];
+        }
+    }
+
+    /** Advances the automation transport by one sample. */
+    void updateTransport(const ProcessArgs &args) {
+        if (resetTrigger.process(inputs[RESET_INPUT].getVoltage(), 0.1f, 1.f)) {
+            clockStarted = false;
+            clockTicks = 0;
+            returnMessage.transport_position = 0.0;
+        }
+
+        if (inputs[CLOCK_INPUT].isConnected()) {
+            samplesSinceClock += 1.f;
+            if (clockTrigger.process(inputs[CLOCK_INPUT].getVoltage(), 0.1f, 1.f)) {
+                // The first clock after a reset is tick 0
+                if (clockStarted) {
+                    clockTicks++;
+                    clockPeriod = samplesSinceClock;
+                }
+                clockStarted = true;
+                samplesSinceClock = 0.f;
+            }
+
+            // Interpolate between clocks, and stop once a clock is two periods late
+            returnMessage.transport_running = clockStarted && clockPeriod > 0.f && samplesSinceClock < 2.f * clockPeriod;
+            if (returnMessage.transport_running) {
+                returnMessage.transport_position = clockTicks + std::min(samplesSinceClock / clockPeriod, 0.999f);
+            }
+        } else {
+            returnMessage.transport_running = true;
+            returnMessage.transport_position += 100.0 * args.sampleTime;
+        }
+        returnMessage.automation = automation;
+    }
+
+    /** Records or plays back the master level lane, called at control rate. */
+    void updateAutomation() {
+        if (clearAutomation.exchange(false)) {
+            levelLane.clear();
+            levelRecording = false;
+        }
+
+        double position = returnMessage.transport_position;
+        if (automation == DAISY_AUTOMATION_RECORD && returnMessage.transport_running) {
+            levelLane.record(position, params[MIX_LVL_PARAM].getValue() / 2.f);
+            levelRecording = true;
+            return;
+        }
+        if (levelRecording) {
+            levelLane.finishRecording();
+            levelRecording = false;
+        }
+        if (automation == DAISY_AUTOMATION_PLAY && !levelLane.empty()) {
+            params[MIX_LVL_PARAM].setValue(levelLane.read(position) * 2.f);
+        }
     }
 
     void process(const ProcessArgs &args) override {
@@ -68,49 +290,92 @@ struct DaisyMaster2 : Module {
         int channels = 1;
         float mix_l[16] = {};
         float mix_r[16] = {};
+        int cueChannels = 0;
+        float cue_l[16] = {};
+        float cue_r[16] = {};
 
-        if (!muted) {
-            // Get daisy-chained data from left-side linked module
-            if (leftExpander.module && (
-                leftExpander.module->model == modelDaisyChannel2
-                || leftExpander.module->model == modelDaisyChannelVu
-                || leftExpander.module->model == modelDaisyChannelSends2
-                || leftExpander.module->model == modelDaisyChannelSends3
-                || leftExpander.module->model == modelDaisyBlank1
-                || leftExpander.module->model == modelDaisyBlank2
-            )) {
-                DaisyMessage *msgFromExpander = (DaisyMessage*)(leftExpander.consumerMessage);
+        // Get daisy-chained data from left-side linked module
+        if (leftExpander.module && (
+            leftExpander.module->model == modelDaisyChannel2
+            || leftExpander.module->model == modelDaisyChannelVu
+            || leftExpander.module->model == modelDaisyChannelSends2
+            || leftExpander.module->model == modelDaisyChannelSends3
+            || leftExpander.module->model == modelDaisyBlank1
+            || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
+        )) {
+            DaisyMessage *msgFromExpander = (DaisyMessage*)(leftExpander.consumerMessage);
 
+            if (!muted) {
                 channels = msgFromExpander->channels;
                 for (int c = 0; c < channels; c++) {
                     mix_l[c] = msgFromExpander->voltages_l[c];
                     mix_r[c] = msgFromExpander->voltages_r[c];
                 }
+            }
+
+            // Keep track of the strips' settings for capturing scenes
+            const DaisyChainState &chainState = msgFromExpander->chain;
+            chainStrips = std::min(chainState.strips, DAISY_MAX_STRIPS);
+            if (chainState.report_strip >= 0 && chainState.report_strip < chainStrips) {
+                stripStates[chainState.report_strip] = chainState.report;
+            }
+            automixPower = chainState.automix_power;
+            automixStrips = chainState.automix_strips;
 
-                link_l = 0.8f;
-            } else {
-                link_l = 0.0f;
+            // The cue bus only arrives while a strip is cued, and ignores the master's mute and level
+            bool cueConnected = outputs[CUE_OUTPUT_1].isConnected() || outputs[CUE_OUTPUT_2].isConnected();
+            if (cueConnected) {
+                cueChannels = chainState.cue_channels;
+                for (int c = 0; c < cueChannels; c++) {
+                    cue_l[c] = daisyHeadroom(msgFromExpander->cue_l[c], headroom);
+                    cue_r[c] = daisyHeadroom(msgFromExpander->cue_r[c], headroom);
+                }
             }
+            cueActive = chainState.cue_channels > 0;
 
+            link_l = 0.8f;
+        } else {
+            chainStrips = 0;
+            automixPower = 0.f;
+            automixStrips = 0;
+            cueActive = false;
+            link_l = 0.0f;
+        }
+
+        int capture = captureRequest.exchange(-1);
+        if (capture >= 0) {
+            scenes[capture].strips = chainStrips;
+            for (int s = 0; s < chainStrips; s++) {
+                scenes[capture].states[s] = stripStates[s];
+            }
+        }
+
+        if (!muted) {
             float gain = params[MIX_LVL_PARAM].getValue();
 
-            // Bring the voltage back up from the chained low voltage
+            // Apply the headroom policy to the bus, then the mix level
             for (int c = 0; c < channels; c++) {
-                mix_l[c] = clamp(mix_l[c] * DAISY_DIVISOR, -12.f, 12.f) * gain;
-                mix_r[c] = clamp(mix_r[c] * DAISY_DIVISOR, -12.f, 12.f) * gain;
+                mix_l[c] = daisyHeadroom(mix_l[c], headroom) * gain;
+                mix_r[c] = daisyHeadroom(mix_r[c], headroom) * gain;
             }
 
-            float mix_cv = 1.f;
             if (inputs[MIX_CV_INPUT].isConnected()) {
-                for (int c = 0; c < channels; c++) {
-                    mix_cv = clamp(inputs[MIX_CV_INPUT].getPolyVoltage(c) / 10.f, 0.f, 1.f);
-                    mix_l[c] *= mix_cv;
-                    mix_r[c] *= mix_cv;
+                for (int c = 0; c < channels; c += 4) {
+                    float_4 mix_cv = simd::clamp(inputs[MIX_CV_INPUT].getPolyVoltageSimd<float_4>(c) / 10.f, 0.f, 1.f);
+                    (float_4::load(&mix_l[c]) * mix_cv).store(&mix_l[c]);
+                    (float_4::load(&mix_r[c]) * mix_cv).store(&mix_r[c]);
                 }
             }
 
-            // Set output to right-side linked VU meter module
-            if (rightExpander.module && rightExpander.module->model == modelDaisyChannelVu) {
+            // Set output to right-side linked VU meter or analyzer module
+            if (rightExpander.module && (
+                rightExpander.module->model == modelDaisyChannelVu
+                || rightExpander.module->model == modelDaisyAnalyzer
+            )) {
                 DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
                 msgToModule->single_channels = channels;
                 for (int c = 0; c < channels; c++) {
@@ -126,10 +391,49 @@ struct DaisyMaster2 : Module {
         outputs[MIX_OUTPUT_2].setChannels(channels);
         outputs[MIX_OUTPUT_2].writeVoltages(mix_r);
 
+        // Monitor the mix on the cue output while nothing is cued
+        if (cueChannels > 0) {
+            outputs[CUE_OUTPUT_1].setChannels(cueChannels);
+            outputs[CUE_OUTPUT_1].writeVoltages(cue_l);
+            outputs[CUE_OUTPUT_2].setChannels(cueChannels);
+            outputs[CUE_OUTPUT_2].writeVoltages(cue_r);
+        } else {
+            outputs[CUE_OUTPUT_1].setChannels(channels);
+            outputs[CUE_OUTPUT_1].writeVoltages(mix_l);
+            outputs[CUE_OUTPUT_2].setChannels(channels);
+            outputs[CUE_OUTPUT_2].writeVoltages(mix_r);
+        }
+
+        // Send scene and automation traffic back up the chain
+        updateTransport(args);
+        if (controlDivider.process()) {
+            updateSceneMorph();
+            updateAutomation();
+
+            // The strips work out their own shares from the total
+            returnMessage.automix = automix && automixStrips > 0;
+            returnMessage.automix_power = automixPower;
+            returnMessage.automix_strips = automixStrips;
+        }
+        updateSceneTraffic();
+
+        if (link_l > 0.f) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
+
         // Set lights
         if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
             lights[MUTE_LIGHT].value = (muted);
             lights[LINK_LIGHT_L].setBrightness(link_l);
+            lights[CUE_LIGHT].setBrightness(cueActive);
+
+            // Dimmed while the transport is stopped
+            float automationLight = returnMessage.transport_running ? 1.f : 0.2f;
+            lights[AUTOMATION_LIGHT + 0].setBrightness(automation == DAISY_AUTOMATION_PLAY ? automationLight : 0.f);
+            lights[AUTOMATION_LIGHT + 1].setBrightness(automation == DAISY_AUTOMATION_RECORD ? automationLight : 0.f);
         }
     }
 };
@@ -147,11 +451,21 @@ struct DaisyMasterWidget2 : ModuleWidget {
         addChild(createWidget<ThemedScrew>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
 
         // Level & CV
-        addParam(createParam<RoundLargeBlackKnob>(Vec(RACK_GRID_WIDTH * 1.5 - (36.0 / 2), 52.0), module, DaisyMaster2::MIX_LVL_PARAM));
-        addInput(createInput<ThemedPJ301MPort>(Vec(RACK_GRID_WIDTH * 1.5 - (25.0 / 2), 96.0), module, DaisyMaster2::MIX_CV_INPUT));
+        addParam(createParam<RoundLargeBlackKnob>(Vec(RACK_GRID_WIDTH * 1.5 - (36.0 / 2), 46.0), module, DaisyMaster2::MIX_LVL_PARAM));
+        addInput(createInput<ThemedPJ301MPort>(Vec(RACK_GRID_WIDTH * 1.5 - (25.0 / 2), 93.0), module, DaisyMaster2::MIX_CV_INPUT));
+
+        // Automation clock & reset
+        addChild(createLightCentered<TinyLight<GreenRedLight>>(Vec(33.0, 124.2), module, DaisyMaster2::AUTOMATION_LIGHT));
+        addInput(createInput<ThemedPJ301MPort>(Vec(RACK_GRID_WIDTH * 1.5 - (25.0 / 2), 129.0), module, DaisyMaster2::CLOCK_INPUT));
+        addInput(createInput<ThemedPJ301MPort>(Vec(RACK_GRID_WIDTH * 1.5 - (25.0 / 2), 165.0), module, DaisyMaster2::RESET_INPUT));
 
         // Mute
-        addParam(createLightParam<VCVLightLatch<MediumSimpleLight<RedLight>>>(Vec(RACK_GRID_WIDTH * 1.5 - 9.0, 254.0), module, DaisyMaster2::MUTE_PARAM, DaisyMaster2::MUTE_LIGHT));
+        addParam(createLightParam<VCVLightLatch<MediumSimpleLight<RedLight>>>(Vec(RACK_GRID_WIDTH * 1.5 - 9.0, 193.0), module, DaisyMaster2::MUTE_PARAM, DaisyMaster2::MUTE_LIGHT));
+
+        // Cue output
+        addChild(createLightCentered<TinyLight<GreenLight>>(Vec(32.5, 223.2), module, DaisyMaster2::CUE_LIGHT));
+        addOutput(createOutput<ThemedPJ301MPort>(Vec((RACK_GRID_WIDTH * 1.5) - (25.0 / 2), 228.0), module, DaisyMaster2::CUE_OUTPUT_1));
+        addOutput(createOutput<ThemedPJ301MPort>(Vec((RACK_GRID_WIDTH * 1.5) - (25.0 / 2), 254.0), module, DaisyMaster2::CUE_OUTPUT_2));
 
         // Mix output
         addOutput(createOutput<ThemedPJ301MPort>(Vec((RACK_GRID_WIDTH * 1.5) - (25.0 / 2), 290.0), module, DaisyMaster2::MIX_OUTPUT_1));
@@ -160,6 +474,82 @@ struct DaisyMasterWidget2 : ModuleWidget {
         // Link light
         addChild(createLightCentered<TinyLight<YellowLight>>(Vec(RACK_GRID_WIDTH - 6, 361.0f), module, DaisyMaster2::LINK_LIGHT_L));
     }
+
+    void appendContextMenu(Menu *menu) override {
+        DaisyMaster2 *module = dynamic_cast<DaisyMaster2 *>(this->module);
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createIndexPtrSubmenuItem("Headroom", {"Clip at 12V", "Soft clip", "Unlimited"}, &module->headroom));
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createMenuLabel("Scenes"));
+
+        menu->addChild(createBoolMenuItem("Follow scene morph", "",
+            [=]() { return module->params[DaisyMaster2::SCENE_ENABLE_PARAM].getValue() > 0.f; },
+            [=](bool enable) { module->params[DaisyMaster2::SCENE_ENABLE_PARAM].setValue(enable); }
+        ));
+
+        ui::Slider *morphSlider = new ui::Slider;
+        morphSlider->quantity = module->paramQuantities[DaisyMaster2::SCENE_PARAM];
+        morphSlider->box.size.x = 200.f;
+        menu->addChild(morphSlider);
+
+        menu->addChild(createSubmenuItem("Capture scene", "", [=](Menu *menu) {
+            for (int i = 0; i < DAISY_SCENES; i++) {
+                menu->addChild(createMenuItem(string::f("Scene %d", i + 1), module->scenes[i].strips > 0 ? "stored" : "",
+                    [=]() { module->captureScene(i); }
+                ));
+            }
+        }));
+
+        menu->addChild(createSubmenuItem("Recall scene", "", [=](Menu *menu) {
+            for (int i = 0; i < DAISY_SCENES; i++) {
+                menu->addChild(createMenuItem(string::f("Scene %d", i + 1), "",
+                    [=]() {
+                        module->params[DaisyMaster2::SCENE_PARAM].setValue(i);
+                        module->params[DaisyMaster2::SCENE_ENABLE_PARAM].setValue(1.f);
+                    },
+                    module->scenes[i].strips == 0
+                ));
+            }
+        }));
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createBoolPtrMenuItem("Gain-sharing automix", "", &module->automix));
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createIndexPtrSubmenuItem("Automation", {"Off", "Play", "Record"}, &module->automation));
+        menu->addChild(createMenuItem("Clear master level automation", "",
+            [=]() { module->clearAutomation = true; }
+        ));
+        if (module->levelLane.full) {
+            menu->addChild(createMenuLabel("Automation full, later moves were dropped"));
+        }
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createMenuLabel("CPU governor"));
+        menu->addChild(createBoolMenuItem("Reduce metering under load", "",
+            [=]() { return (bool)daisyGovernor.enabled; },
+            [=](bool enable) { daisyGovernor.enabled = enable; }
+        ));
+
+        std::vector<std::string> loadLabels;
+        for (int i = 0; i < DAISY_GOVERNOR_LOAD_COUNT; i++) {
+            loadLabels.push_back(string::f("%d%%", (int)std::round(DAISY_GOVERNOR_LOADS[i] * 100.f)));
+        }
+        menu->addChild(createIndexSubmenuItem("Reduce above", loadLabels,
+            [=]() { return daisyGovernorLoadIndex(daisyGovernor.reduceLoad); },
+            [=](size_t i) { daisyGovernor.setThresholds(DAISY_GOVERNOR_LOADS[i], daisyGovernor.restoreLoad); }
+        ));
+        menu->addChild(createIndexSubmenuItem("Restore below", loadLabels,
+            [=]() { return daisyGovernorLoadIndex(daisyGovernor.restoreLoad); },
+            [=](size_t i) { daisyGovernor.setThresholds(daisyGovernor.reduceLoad, DAISY_GOVERNOR_LOADS[i]); }
+        ));
+
+        static const char *qualityLabels[DAISY_QUALITY_COUNT] = {"Full", "Reduced", "Minimal"};
+        menu->addChild(createMenuLabel(string::f("Engine load %d%%, metering %s",
+            (int)std::round(daisyGovernor.load * 100.f), qualityLabels[daisyGovernor.quality])));
+    }
 };
 
 Model *modelDaisyMaster2 = createModel<DaisyMaster2, DaisyMasterWidget2>("DaisyMaster2");
@@ -0,0 +1,12 @@
+#include "QuantalAudioExtendedMixer.hpp"
+#include "DaisyMath.hpp"
+
+float daisyPanTable[DAISY_PAN_TABLE_SIZE + 2][2];
+
+void daisyMathInit() {
+    for (int i = 0; i <= DAISY_PAN_TABLE_SIZE + 1; i++) {
+        double angle = M_PI / 2 * std::min(i, DAISY_PAN_TABLE_SIZE) / DAISY_PAN_TABLE_SIZE;
+        daisyPanTable[i][0] = (float)std::cos(angle);
+        daisyPanTable[i][1] = (float)std::sin(angle);
+    }
+}
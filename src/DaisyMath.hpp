@@ -0,0 +1,112 @@
+#if !defined(DAISY_MATH_H)
+#define DAISY_MATH_H 1
+
+/*
+ * Fast approximations for the per-sample gain math of the chain. Error
+ * bounds were measured in single precision over the stated input ranges.
+ * Control-rate code (coefficients, parameter displays) keeps using libm.
+ */
+
+// 20 * log10(2) and its inverse, convert between log2 and dB
+const float DAISY_DB_PER_LOG2 = 6.0205999f;
+const float DAISY_LOG2_PER_DB = 0.16609640f;
+
+// Quietest level reported by daisyAmplitudeToDb(), in dB
+const float DAISY_DB_FLOOR = -200.f;
+
+// Intervals in the constant-power pan table, from hard left to hard right
+const int DAISY_PAN_TABLE_SIZE = 1024;
+
+// Left and right gains at each table point, plus one guard point for pan = 1
+extern float daisyPanTable[DAISY_PAN_TABLE_SIZE + 2][2];
+
+/** Builds the lookup tables, once from the plugin init(). */
+void daisyMathInit();
+
+/** 2^f for f in [0, 1), relative error under 2e-7. */
+template <typename T>
+inline T daisyExp2Fraction(T f) {
+    return ((((1.893754058e-3f * f + 8.949590423e-3f) * f + 5.586033708e-2f) * f + 2.401418182e-1f) * f + 6.931544897e-1f) * f + 9.999998984e-1f;
+}
+
+/** log2(1 + m) for m in [0, 1), absolute error under 3e-6. */
+template <typename T>
+inline T daisyLog2Mantissa(T m) {
+    return (((((-2.456853475e-2f * m + 1.176130841e-1f) * m - 2.726975649e-1f) * m + 4.545084922e-1f) * m - 7.173127803e-1f) * m + 1.442453526f) * m + 2.443438720e-6f;
+}
+
+/** 2^x, relative error under 2e-7. x is clamped to [-126, 126]. */
+inline float daisyExp2(float x) {
+    x = clamp(x, -126.f, 126.f);
+    int xi = (int)x;
+    xi -= (x < xi);
+    int32_t bits = (xi + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return daisyExp2Fraction(x - xi) * scale;
+}
+
+inline simd::float_4 daisyExp2(simd::float_4 x) {
+    x = simd::clamp(x, -126.f, 126.f);
+    simd::float_4 xf = simd::floor(x);
+    simd::int32_4 bits = (simd::int32_4(xf) + 127) << 23;
+    return daisyExp2Fraction(x - xf) * simd::float_4::cast(bits);
+}
+
+/** log2(x) for positive normal x, absolute error under 4e-6 for x in [2^-30, 2^10]. */
+inline float daisyLog2(float x) {
+    int32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    float e = (float)((bits >> 23) - 127);
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    return e + daisyLog2Mantissa(m - 1.f);
+}
+
+inline simd::float_4 daisyLog2(simd::float_4 x) {
+    simd::int32_4 bits = simd::int32_4::cast(x);
+    simd::float_4 e = simd::float_4((bits >> 23) - 127);
+    simd::float_4 m = simd::float_4::cast((bits & 0x007fffff) | 0x3f800000);
+    return e + daisyLog2Mantissa(m - 1.f);
+}
+
+/** Linear gain for a level in dB, relative error under 1e-6 across +-120 dB. */
+template <typename T>
+inline T daisyDbToAmplitude(T db) {
+    return daisyExp2(db * DAISY_LOG2_PER_DB);
+}
+
+/** Level in dB of a linear gain, absolute error under 3e-5 dB from -180 to +60 dB, floored at DAISY_DB_FLOOR. */
+inline float daisyAmplitudeToDb(float amplitude) {
+    return DAISY_DB_PER_LOG2 * daisyLog2(std::max(amplitude, 1e-10f));
+}
+
+inline simd::float_4 daisyAmplitudeToDb(simd::float_4 amplitude) {
+    return DAISY_DB_PER_LOG2 * daisyLog2(simd::fmax(amplitude, 1e-10f));
+}
+
+/**
+ * Constant-power pan gains, cos and sin of (pan + 1) * pi / 4 for pan in
+ * [-1, 1]. Linear interpolation in the table keeps the error under 4e-7.
+ */
+inline void daisyPan(float pan, float &gain_l, float &gain_r) {
+    float x = (clamp(pan, -1.f, 1.f) + 1.f) * (0.5f * DAISY_PAN_TABLE_SIZE);
+    int i = (int)x;
+    float t = x - i;
+    const float *a = daisyPanTable[i];
+    const float *b = daisyPanTable[i + 1];
+    gain_l = a[0] + (b[0] - a[0]) * t;
+    gain_r = a[1] + (b[1] - a[1]) * t;
+}
+
+/** Brightness of a meter segment, as dsp::VuMeter2::getBrightness() but from a level already in dB. */
+inline float daisyMeterBrightness(float db, float dbMin, float dbMax) {
+    if (db >= dbMax)
+        return 1.f;
+    else if (db <= dbMin)
+        return 0.f;
+    return rescale(db, dbMin, dbMax, 0.f, 1.f);
+}
+
+#endif
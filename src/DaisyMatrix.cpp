@@ -0,0 +1,340 @@
+#include "QuantalAudioExtendedMixer.hpp"
+#include "Daisy.hpp"
+#include "DaisyGovernor.hpp"
+
+static const int MATRIX_VOICES = 16;
+static const int MATRIX_OUTPUTS = 4;
+static const int MATRIX_BLOCKS = MATRIX_VOICES / 4;
+
+// Samples between gain updates, each change ramps across one update
+static const int MATRIX_RAMP = 32;
+
+struct DaisyMatrix : Module {
+    enum ParamIds {
+        ENUMS(GAIN_PARAMS, MATRIX_OUTPUTS * MATRIX_VOICES),
+        NUM_PARAMS
+    };
+    enum InputIds {
+        NUM_INPUTS
+    };
+    enum OutputIds {
+        ENUMS(OUT_OUTPUTS_L, MATRIX_OUTPUTS),
+        ENUMS(OUT_OUTPUTS_R, MATRIX_OUTPUTS),
+        NUM_OUTPUTS
+    };
+    enum LightsIds {
+        LINK_LIGHT_L,
+        LINK_LIGHT_R,
+        NUM_LIGHTS
+    };
+
+    float link_l = 0.f;
+    float link_r = 0.f;
+    int headroom = DAISY_HEADROOM_CLIP;
+    dsp::ClockDivider lightDivider;
+    dsp::ClockDivider gainDivider;
+
+    // Gains per output, in blocks of four voices, ramping towards their targets
+    simd::float_4 gain[MATRIX_OUTPUTS][MATRIX_BLOCKS] = {};
+    simd::float_4 gainTarget[MATRIX_OUTPUTS][MATRIX_BLOCKS] = {};
+    simd::float_4 gainStep[MATRIX_OUTPUTS][MATRIX_BLOCKS] = {};
+    bool ramping = false;
+
+    // Outputs that are patched and have a gain, and voice blocks some output uses
+    bool rowActive[MATRIX_OUTPUTS] = {};
+    bool blockActive[MATRIX_BLOCKS] = {};
+
+    DaisyMessage daisyInputMessage[2][1];
+    DaisyReturnMessage daisyReturnMessage[2][1];
+
+    DaisyMatrix() {
+        config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+
+        for (int k = 0; k < MATRIX_OUTPUTS; k++) {
+            for (int v = 0; v < MATRIX_VOICES; v++) {
+                configParam(GAIN_PARAMS + k * MATRIX_VOICES + v, 0.0f, 1.0f, 0.0f,
+                    string::f("Voice %d to output %d", v + 1, k + 1), " dB", -10, 20);
+            }
+            configOutput(OUT_OUTPUTS_L + k, string::f("Output %d L", k + 1));
+            configOutput(OUT_OUTPUTS_R + k, string::f("Output %d R", k + 1));
+        }
+
+        configLight(LINK_LIGHT_L, "Daisy chain link input");
+        configLight(LINK_LIGHT_R, "Daisy chain link output");
+
+        // Set the expander messages
+        leftExpander.producerMessage = &daisyInputMessage[0];
+        leftExpander.consumerMessage = &daisyInputMessage[1];
+        rightExpander.producerMessage = &daisyReturnMessage[0];
+        rightExpander.consumerMessage = &daisyReturnMessage[1];
+
+        lightDivider.setDivision(512);
+        gainDivider.setDivision(MATRIX_RAMP);
+    }
+
+    json_t *dataToJson() override {
+        json_t *rootJ = json_object();
+
+        // headroom
+        json_object_set_new(rootJ, "headroom", json_integer(headroom));
+
+        return rootJ;
+    }
+
+    void dataFromJson(json_t *rootJ) override {
+        // headroom
+        json_t *headroomJ = json_object_get(rootJ, "headroom");
+        if (headroomJ)
+            headroom = clamp((int)json_integer_value(headroomJ), 0, DAISY_HEADROOM_COUNT - 1);
+    }
+
+    /** Starts a ramp to the current knob settings and works out which rows and blocks to skip, at control rate. */
+    void updateGains() {
+        ramping = false;
+        for (int b = 0; b < MATRIX_BLOCKS; b++) {
+            blockActive[b] = false;
+        }
+
+        for (int k = 0; k < MATRIX_OUTPUTS; k++) {
+            bool patched = outputs[OUT_OUTPUTS_L + k].isConnected() || outputs[OUT_OUTPUTS_R + k].isConnected();
+            rowActive[k] = false;
+
+            for (int b = 0; b < MATRIX_BLOCKS; b++) {
+                // Land exactly on the last target before heading to the next
+                gain[k][b] = gainTarget[k][b];
+
+                const int first = GAIN_PARAMS + k * MATRIX_VOICES + 4 * b;
+                // Linear gains, as the cells display them in dB
+                gainTarget[k][b] = simd::float_4(params[first].getValue(), params[first + 1].getValue(),
+                                                 params[first + 2].getValue(), params[first + 3].getValue());
+                gainStep[k][b] = (gainTarget[k][b] - gain[k][b]) / MATRIX_RAMP;
+
+                bool used = simd::movemask((gain[k][b] != 0.f) | (gainTarget[k][b] != 0.f)) != 0;
+                ramping = ramping || simd::movemask(gainStep[k][b] != 0.f) != 0;
+                if (used && patched) {
+                    rowActive[k] = true;
+                    blockActive[b] = true;
+                }
+            }
+        }
+    }
+
+    /** Mixes the chain voices to each active output, a float_4 matrix-vector product. */
+    void processMatrix(int chainChannels, const float *signals_l, const float *signals_r, float *out_l, float *out_r) {
+        int blocks = (chainChannels + 3) / 4;
+
+        for (int k = 0; k < MATRIX_OUTPUTS; k++) {
+            if (ramping) {
+                for (int b = 0; b < MATRIX_BLOCKS; b++) {
+                    gain[k][b] += gainStep[k][b];
+                }
+            }
+
+            out_l[k] = 0.f;
+            out_r[k] = 0.f;
+            if (!rowActive[k]) {
+                continue;
+            }
+
+            simd::float_4 sum_l = 0.f;
+            simd::float_4 sum_r = 0.f;
+            for (int b = 0; b < blocks; b++) {
+                if (blockActive[b]) {
+                    sum_l += gain[k][b] * simd::float_4::load(&signals_l[4 * b]);
+                    sum_r += gain[k][b] * simd::float_4::load(&signals_r[4 * b]);
+                }
+            }
+            out_l[k] = sum_l[0] + sum_l[1] + sum_l[2] + sum_l[3];
+            out_r[k] = sum_r[0] + sum_r[1] + sum_r[2] + sum_r[3];
+        }
+    }
+
+    void process(const ProcessArgs &args) override {
+        float daisySignals_l[MATRIX_VOICES] = {};
+        float daisySignals_r[MATRIX_VOICES] = {};
+        float out_l[MATRIX_OUTPUTS];
+        float out_r[MATRIX_OUTPUTS];
+        int chainChannels = 1;
+        DaisyChainState chainState;
+        DaisyReturnMessage returnMessage;
+
+        if (gainDivider.process()) {
+            updateGains();
+        }
+
+        // Get daisy-chained data from left-side linked module
+        if (leftExpander.module && (
+            leftExpander.module->model == modelDaisyChannel2
+            || leftExpander.module->model == modelDaisyChannelVu
+            || leftExpander.module->model == modelDaisyChannelSends2
+            || leftExpander.module->model == modelDaisyChannelSends3
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyBlank1
+            || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
+        )) {
+            DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
+            chainChannels = msgFromModule->channels;
+            chainState = msgFromModule->chain;
+            for (int c = 0; c < chainChannels; c++) {
+                daisySignals_l[c] = msgFromModule->voltages_l[c];
+                daisySignals_r[c] = msgFromModule->voltages_r[c];
+            }
+
+            link_l = 0.8f;
+        } else {
+            link_l = 0.0f;
+        }
+
+        processMatrix(chainChannels, daisySignals_l, daisySignals_r, out_l, out_r);
+
+        // Set daisy-chained output to right-side linked module, the chain passes through untouched
+        if (rightExpander.module && (
+            rightExpander.module->model == modelDaisyMaster2
+            || rightExpander.module->model == modelDaisyChannel2
+            || rightExpander.module->model == modelDaisyChannelVu
+            || rightExpander.module->model == modelDaisyChannelSends2
+            || rightExpander.module->model == modelDaisyChannelSends3
+            || rightExpander.module->model == modelDaisyChannelDynamics
+            || rightExpander.module->model == modelDaisyAnalyzer
+            || rightExpander.module->model == modelDaisyBlank1
+            || rightExpander.module->model == modelDaisyBlank2
+            || rightExpander.module->model == modelDaisyReverb
+            || rightExpander.module->model == modelDaisyMatrix
+        )) {
+            DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
+
+            msgToModule->channels = chainChannels;
+            msgToModule->chain = chainState;
+            daisyRelayCue(chainState, (DaisyMessage *)(leftExpander.consumerMessage), msgToModule);
+
+            // Get the return message coming back from the master
+            returnMessage = *(DaisyReturnMessage *)(rightExpander.consumerMessage);
+
+            // Pass the single voltages through untouched, e.g. a strip's signal on to a VU meter
+            if (returnMessage.needs_single) {
+                DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
+                int singleChannels = link_l > 0.f ? msgFromModule->single_channels : 0;
+                msgToModule->single_channels = singleChannels;
+                for (int c = 0; c < singleChannels; c++) {
+                    msgToModule->single_voltages_l[c] = msgFromModule->single_voltages_l[c];
+                    msgToModule->single_voltages_r[c] = msgFromModule->single_voltages_r[c];
+                }
+            }
+
+            for (int c = 0; c < chainChannels; c++) {
+                msgToModule->voltages_l[c] = daisySignals_l[c];
+                msgToModule->voltages_r[c] = daisySignals_r[c];
+            }
+
+            rightExpander.module->leftExpander.messageFlipRequested = true;
+
+            link_r = 0.8f;
+        } else {
+            link_r = 0.0f;
+        }
+
+        // Apply the headroom policy to the outputs leaving the chain
+        for (int k = 0; k < MATRIX_OUTPUTS; k++) {
+            if (rowActive[k]) {
+                outputs[OUT_OUTPUTS_L + k].setVoltage(daisyHeadroom(out_l[k], headroom));
+                outputs[OUT_OUTPUTS_R + k].setVoltage(daisyHeadroom(out_r[k], headroom));
+            } else {
+                outputs[OUT_OUTPUTS_L + k].setVoltage(0.f);
+                outputs[OUT_OUTPUTS_R + k].setVoltage(0.f);
+            }
+        }
+
+        // Pass the return message on to the left-side linked module. The matrix reads no
+        // single voltages itself, so it asks only for what the modules on its right read.
+        if (link_l > 0.f) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
+
+        // Set lights
+        if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
+            lights[LINK_LIGHT_L].setBrightness(link_l);
+            lights[LINK_LIGHT_R].setBrightness(link_r);
+        }
+    }
+};
+
+/** One matrix gain, drawn as a cell that fills as the gain rises. Drag to change, double-click to reset. */
+struct DaisyMatrixCell : app::Knob {
+    DaisyMatrixCell() {
+        box.size = Vec(8.6f, 12.f);
+    }
+
+    void draw(const DrawArgs &args) override {
+        float value = 0.f;
+        if (ParamQuantity *pq = getParamQuantity()) {
+            value = pq->getScaledValue();
+        }
+
+        nvgBeginPath(args.vg);
+        nvgRect(args.vg, 0.f, 0.f, box.size.x, box.size.y);
+        nvgFillColor(args.vg, nvgRGB(0x30, 0x30, 0x30));
+        nvgFill(args.vg);
+
+        if (value > 0.f) {
+            float height = box.size.y * value;
+            nvgBeginPath(args.vg);
+            nvgRect(args.vg, 0.f, box.size.y - height, box.size.x, height);
+            nvgFillColor(args.vg, nvgRGB(0x55, 0xc0, 0x46));
+            nvgFill(args.vg);
+        }
+    }
+};
+
+struct DaisyMatrixWidget : ModuleWidget {
+    DaisyMatrixWidget(DaisyMatrix *module) {
+        setModule(module);
+        setPanel(createPanel(asset::plugin(pluginInstance, "res/DaisyMatrix.svg"), asset::plugin(pluginInstance, "res/DaisyMatrix-dark.svg")));
+
+        // Screws
+        addChild(createWidget<ThemedScrew>(Vec(RACK_GRID_WIDTH, 0)));
+        addChild(createWidget<ThemedScrew>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+
+        // Gain grid, a column per chain voice and a row per output
+        for (int k = 0; k < MATRIX_OUTPUTS; k++) {
+            for (int v = 0; v < MATRIX_VOICES; v++) {
+                addParam(createParam<DaisyMatrixCell>(Vec(17.0 + 9.6 * v, 64.0 + 16.0 * k), module, DaisyMatrix::GAIN_PARAMS + k * MATRIX_VOICES + v));
+            }
+        }
+
+        // Outputs, a stereo pair per row
+        for (int k = 0; k < MATRIX_OUTPUTS; k++) {
+            addOutput(createOutput<ThemedPJ301MPort>(Vec(30.0 + 40.0 * k - 12.5, 290.0), module, DaisyMatrix::OUT_OUTPUTS_L + k));
+            addOutput(createOutput<ThemedPJ301MPort>(Vec(30.0 + 40.0 * k - 12.5, 316.0), module, DaisyMatrix::OUT_OUTPUTS_R + k));
+        }
+
+        // Link lights
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(box.size.x / 2 - 4, 361.0f), module, DaisyMatrix::LINK_LIGHT_L));
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(box.size.x / 2 + 4, 361.0f), module, DaisyMatrix::LINK_LIGHT_R));
+    }
+
+    void appendContextMenu(Menu *menu) override {
+        DaisyMatrix *module = dynamic_cast<DaisyMatrix *>(this->module);
+
+        menu->addChild(new MenuSeparator);
+        menu->addChild(createIndexPtrSubmenuItem("Headroom", {"Clip at 12V", "Soft clip", "Unlimited"}, &module->headroom));
+
+        menu->addChild(createMenuItem("Clear matrix", "", [=]() {
+            for (int i = 0; i < MATRIX_OUTPUTS * MATRIX_VOICES; i++) {
+                module->params[DaisyMatrix::GAIN_PARAMS + i].setValue(0.f);
+            }
+        }));
+        menu->addChild(createMenuItem("Route all voices to output 1", "", [=]() {
+            for (int i = 0; i < MATRIX_OUTPUTS * MATRIX_VOICES; i++) {
+                module->params[DaisyMatrix::GAIN_PARAMS + i].setValue(i < MATRIX_VOICES ? 1.f : 0.f);
+            }
+        }));
+    }
+};
+
+Model *modelDaisyMatrix = createModel<DaisyMatrix, DaisyMatrixWidget>("DaisyMatrix");
@@ -0,0 +1,733 @@
+#include "QuantalAudioExtendedMixer.hpp"
+#include "Daisy.hpp"
+#include "DaisyGovernor.hpp"
+#include <osdialog.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Block size of the head partitions, convolved on the audio thread
+const int REVERB_HEAD_BLOCK = 128;
+
+// Block size of the tail partitions, convolved on the worker thread
+const int REVERB_TAIL_BLOCK = 2048;
+
+// The head covers the IR up to where the worker's first output is due
+const int REVERB_HEAD_LENGTH = 2 * REVERB_TAIL_BLOCK;
+
+// Longer IRs are cut off
+const float REVERB_MAX_SECONDS = 10.f;
+
+/** Multiplies two spectra in RealFFT's ordered layout and adds the product to an accumulator. */
+static void spectrumMultiplyAdd(const float *a, const float *b, float *acc, int length) {
+    // DC and Nyquist are real
+    acc[0] += a[0] * b[0];
+    acc[1] += a[1] * b[1];
+    for (int i = 2; i < length; i += 2) {
+        acc[i] += a[i] * b[i] - a[i + 1] * b[i + 1];
+        acc[i + 1] += a[i] * b[i + 1] + a[i + 1] * b[i];
+    }
+}
+
+/**
+ * Uniformly partitioned overlap-save convolution of one channel, one block
+ * of BLOCK samples in and out per call. The IR spectra are built once by
+ * init(), processing does not allocate.
+ */
+template <int BLOCK>
+struct ReverbPartitions {
+    dsp::RealFFT fft {2 * BLOCK};
+    int partitions = 0;
+
+    // IR spectra and the frequency-domain delay line of input spectra
+    std::vector<float> irSpectra;
+    std::vector<float> inputSpectra;
+    int newest = 0;
+
+    alignas(16) float window[2 * BLOCK] = {};
+    alignas(16) float accumulator[2 * BLOCK] = {};
+    alignas(16) float result[2 * BLOCK] = {};
+
+    void init(const float *ir, int length) {
+        partitions = std::max((length + BLOCK - 1) / BLOCK, 1);
+        irSpectra.assign(partitions * 2 * BLOCK, 0.f);
+        inputSpectra.assign(partitions * 2 * BLOCK, 0.f);
+
+        alignas(16) float segment[2 * BLOCK];
+        for (int p = 0; p < partitions; p++) {
+            std::fill(segment, segment + 2 * BLOCK, 0.f);
+            int n = clamp(length - p * BLOCK, 0, BLOCK);
+            std::copy(ir + p * BLOCK, ir + p * BLOCK + n, segment);
+            float *spectrum = &irSpectra[p * 2 * BLOCK];
+            fft.rfft(segment, spectrum);
+
+            // Fold the inverse FFT's scaling into the IR
+            fft.scale(spectrum);
+        }
+    }
+
+    void process(const float *in, float *out) {
+        std::copy(window + BLOCK, window + 2 * BLOCK, window);
+        std::copy(in, in + BLOCK, window + BLOCK);
+
+        newest = (newest + partitions - 1) % partitions;
+        fft.rfft(window, &inputSpectra[newest * 2 * BLOCK]);
+
+        std::fill(accumulator, accumulator + 2 * BLOCK, 0.f);
+        for (int p = 0; p < partitions; p++) {
+            int slot = (newest + p) % partitions;
+            spectrumMultiplyAdd(&inputSpectra[slot * 2 * BLOCK], &irSpectra[p * 2 * BLOCK], accumulator, 2 * BLOCK);
+        }
+        fft.irfft(accumulator, result);
+
+        // The second half is free of circular wrap-around
+        std::copy(result + BLOCK, result + 2 * BLOCK, out);
+    }
+
+    /** Advances the delay line by a block of silence, keeping later blocks aligned. */
+    void skip() {
+        std::copy(window + BLOCK, window + 2 * BLOCK, window);
+        std::fill(window + BLOCK, window + 2 * BLOCK, 0.f);
+
+        newest = (newest + partitions - 1) % partitions;
+        std::fill(&inputSpectra[newest * 2 * BLOCK], &inputSpectra[(newest + 1) * 2 * BLOCK], 0.f);
+    }
+};
+
+/**
+ * Stereo convolution with a loaded IR. The head of the IR is convolved on
+ * the audio thread in short blocks, the tail in long blocks on the worker.
+ * The worker gets one tail block period to deliver each block, and the wet
+ * signal comes out REVERB_HEAD_BLOCK samples late.
+ */
+struct ReverbEngine {
+    ReverbPartitions<REVERB_HEAD_BLOCK> head[2];
+    ReverbPartitions<REVERB_TAIL_BLOCK> tail[2];
+    bool loaded = false;
+    bool hasTail = false;
+
+    // Audio thread buffers
+    int position = 0;
+    float headInput[2][REVERB_HEAD_BLOCK] = {};
+    float headOutput[2][REVERB_HEAD_BLOCK] = {};
+    float tailInput[2][REVERB_TAIL_BLOCK] = {};
+    float tailOutput[2][REVERB_TAIL_BLOCK] = {};
+    float tailPrevious[2][REVERB_TAIL_BLOCK] = {};
+
+    // Tail job handed to the worker, owned by whichever side holds the job
+    float jobInput[2][REVERB_TAIL_BLOCK] = {};
+    float jobOutput[2][REVERB_TAIL_BLOCK] = {};
+    int jobSkipped = 0;
+    bool jobReady = false;
+
+    // Audio thread bookkeeping of missed deadlines
+    int lateBlocks = 0;
+    bool jobLate = false;
+
+    ReverbEngine(const std::vector<float> *ir) {
+        for (int c = 0; c < 2; c++) {
+            int length = ir[c].size();
+            loaded = loaded || length > 0;
+            head[c].init(ir[c].data(), std::min(length, REVERB_HEAD_LENGTH));
+            if (length > REVERB_HEAD_LENGTH) {
+                tail[c].init(ir[c].data() + REVERB_HEAD_LENGTH, length - REVERB_HEAD_LENGTH);
+                hasTail = true;
+            }
+        }
+    }
+
+    /** Convolves one stereo frame, returns true when a tail block is complete. */
+    bool process(const float *in, float *out) {
+        int headPosition = position % REVERB_HEAD_BLOCK;
+        int tailPosition = position - REVERB_HEAD_BLOCK;
+
+        for (int c = 0; c < 2; c++) {
+            headInput[c][headPosition] = in[c];
+            tailInput[c][position] = in[c];
+
+            float t = tailPosition >= 0 ? tailOutput[c][tailPosition] : tailPrevious[c][REVERB_TAIL_BLOCK + tailPosition];
+            out[c] = headOutput[c][headPosition] + t;
+        }
+
+        if (headPosition == REVERB_HEAD_BLOCK - 1) {
+            for (int c = 0; c < 2; c++) {
+                head[c].process(headInput[c], headOutput[c]);
+            }
+        }
+
+        if (++position < REVERB_TAIL_BLOCK) {
+            return false;
+        }
+        position = 0;
+        return hasTail;
+    }
+
+    /** Runs a posted tail job, called on the worker thread. */
+    void processTail() {
+        for (int c = 0; c < 2; c++) {
+            for (int i = 0; i < jobSkipped; i++) {
+                tail[c].skip();
+            }
+            tail[c].process(jobInput[c], jobOutput[c]);
+        }
+        jobReady = true;
+    }
+};
+
+/** Reads a PCM or float WAV file, returns the number of channels used or 0 on failure. */
+static int loadWav(const std::string &path, std::vector<float> *channels, float &sampleRate) {
+    std::vector<uint8_t> data;
+    try {
+        data = system::readFile(path);
+    } catch (Exception &e) {
+        WARN("Could not read IR %s: %s", path.c_str(), e.what());
+        return 0;
+    }
+
+    auto u16 = [&](size_t i) {
+        return (uint32_t)data[i] | (uint32_t)data[i + 1] << 8;
+    };
+    auto u32 = [&](size_t i) {
+        return u16(i) | u16(i + 2) << 16;
+    };
+
+    if (data.size() < 12 || std::memcmp(&data[0], "RIFF", 4) || std::memcmp(&data[8], "WAVE", 4)) {
+        return 0;
+    }
+
+    int format = 0;
+    int fileChannels = 0;
+    int bits = 0;
+    size_t samples = 0;
+    size_t samplesSize = 0;
+    for (size_t i = 12; i + 8 <= data.size();) {
+        size_t chunkSize = u32(i + 4);
+        size_t body = i + 8;
+        chunkSize = std::min(chunkSize, data.size() - body);
+        if (!std::memcmp(&data[i], "fmt ", 4) && chunkSize >= 16) {
+            format = u16(body);
+            fileChannels = u16(body + 2);
+            sampleRate = u32(body + 4);
+            bits = u16(body + 14);
+            // WAVE_FORMAT_EXTENSIBLE keeps the real format in the subformat GUID
+            if (format == 0xfffe && chunkSize >= 26) {
+                format = u16(body + 24);
+            }
+        } else if (!std::memcmp(&data[i], "data", 4)) {
+            samples = body;
+            samplesSize = chunkSize;
+        }
+        // Chunks are padded to an even size
+        i = body + chunkSize + (chunkSize & 1);
+    }
+
+    bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+    bool ieee = format == 3 && bits == 32;
+    if ((!pcm && !ieee) || fileChannels < 1 || samples == 0 || sampleRate <= 0.f) {
+        WARN("Unsupported IR format in %s", path.c_str());
+        return 0;
+    }
+
+    int used = std::min(fileChannels, 2);
+    size_t frameSize = fileChannels * bits / 8;
+    size_t frames = std::min(samplesSize / frameSize, (size_t)(REVERB_MAX_SECONDS * sampleRate));
+    for (int c = 0; c < used; c++) {
+        channels[c].resize(frames);
+        for (size_t f = 0; f < frames; f++) {
+            size_t at = samples + f * frameSize + c * bits / 8;
+            float v;
+            if (ieee) {
+                uint32_t u = u32(at);
+                std::memcpy(&v, &u, sizeof(v));
+            } else if (bits == 16) {
+                v = (int16_t)u16(at) / 32768.f;
+            } else if (bits == 24) {
+                v = (int32_t)(u16(at) << 8 | (uint32_t)data[at + 2] << 24) / 2147483648.f;
+            } else {
+                v = (int32_t)u32(at) / 2147483648.f;
+            }
+            channels[c][f] = v;
+        }
+    }
+    return used;
+}
+
+struct DaisyReverb : Module {
+    enum ParamIds {
+        RETURN_LVL_PARAM,
+        NUM_PARAMS
+    };
+    enum InputIds {
+        IN_INPUT_1, // Left
+        IN_INPUT_2, // Right
+        NUM_INPUTS
+    };
+    enum OutputIds {
+        WET_OUTPUT_1, // Left
+        WET_OUTPUT_2, // Right
+        NUM_OUTPUTS
+    };
+    enum LightsIds {
+        IR_LIGHT,
+        LINK_LIGHT_L,
+        LINK_LIGHT_R,
+        NUM_LIGHTS
+    };
+
+    float link_l = 0.f;
+    float link_r = 0.f;
+    dsp::ClockDivider lightDivider;
+
+    // Engine owned by the audio thread, and the hand-offs to and from the worker
+    ReverbEngine *engine = NULL;
+    std::atomic<ReverbEngine *> pendingEngine {NULL};
+    std::atomic<ReverbEngine *> retiredEngine {NULL};
+    std::atomic<ReverbEngine *> tailJob {NULL};
+
+    // IR file, guarded by loadMutex, loaded on the loader thread
+    std::mutex loadMutex;
+    std::string irPath;
+    bool loadRequested = false;
+    std::atomic<float> engineSampleRate {44100.f};
+
+    // The worker only runs tail blocks, the loader builds and frees engines. Both sleep until woken,
+    // and the audio thread notifies without the lock, so they also wake on a short timeout to catch
+    // a notify that lands between their check and their wait.
+    std::thread worker;
+    std::atomic<bool> workerRunning {true};
+    std::mutex workerMutex;
+    std::condition_variable workerCv;
+    std::thread loader;
+    std::condition_variable loaderCv;
+
+    DaisyMessage daisyInputMessage[2][1];
+    DaisyReturnMessage daisyReturnMessage[2][1];
+
+    DaisyReverb() {
+        config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+        configParam(RETURN_LVL_PARAM, 0.0f, 1.0f, 0.5f, "Return level", " dB", -10, 20);
+
+        configInput(IN_INPUT_1, "Send L");
+        configInput(IN_INPUT_2, "Send R");
+        configOutput(WET_OUTPUT_1, "Wet L");
+        configOutput(WET_OUTPUT_2, "Wet R");
+
+        configLight(IR_LIGHT, "IR loaded");
+        configLight(LINK_LIGHT_L, "Daisy chain link input");
+        configLight(LINK_LIGHT_R, "Daisy chain link output");
+
+        // Set the expander messages
+        leftExpander.producerMessage = &daisyInputMessage[0];
+        leftExpander.consumerMessage = &daisyInputMessage[1];
+        rightExpander.producerMessage = &daisyReturnMessage[0];
+        rightExpander.consumerMessage = &daisyReturnMessage[1];
+
+        lightDivider.setDivision(512);
+        engineSampleRate = APP->engine->getSampleRate();
+
+        worker = std::thread([this]() {
+            workerLoop();
+        });
+        loader = std::thread([this]() {
+            loaderLoop();
+        });
+    }
+
+    ~DaisyReverb() {
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            workerRunning = false;
+        }
+        workerCv.notify_one();
+        {
+            std::lock_guard<std::mutex> lock(loadMutex);
+            loaderCv.notify_one();
+        }
+        worker.join();
+        loader.join();
+
+        delete engine;
+        delete pendingEngine.load();
+        delete retiredEngine.load();
+    }
+
+    json_t *dataToJson() override {
+        json_t *rootJ = json_object();
+
+        // IR file
+        std::lock_guard<std::mutex> lock(loadMutex);
+        json_object_set_new(rootJ, "path", json_string(irPath.c_str()));
+
+        return rootJ;
+    }
+
+    void dataFromJson(json_t *rootJ) override {
+        // IR file
+        json_t *pathJ = json_object_get(rootJ, "path");
+        if (pathJ)
+            loadIr(json_string_value(pathJ));
+    }
+
+    void onSampleRateChange(const SampleRateChangeEvent &e) override {
+        engineSampleRate = e.sampleRate;
+        std::lock_guard<std::mutex> lock(loadMutex);
+        loadRequested = true;
+        loaderCv.notify_one();
+    }
+
+    /** Asks the loader to load an IR file, an empty path unloads it. */
+    void loadIr(const std::string &path) {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        irPath = path;
+        loadRequested = true;
+        loaderCv.notify_one();
+    }
+
+    std::string getIrName() {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        return system::getFilename(irPath);
+    }
+
+    /** Builds a new engine from the IR file at the current sample rate, on the loader. */
+    ReverbEngine *buildEngine(const std::string &path) {
+        std::vector<float> ir[2];
+        float fileRate = 0.f;
+        int used = loadWav(path, ir, fileRate);
+        if (used == 0) {
+            return NULL;
+        }
+        if (used == 1) {
+            ir[1] = ir[0];
+        }
+
+        // Resample to the engine rate, padded so the resampler's delay is flushed
+        int rate = engineSampleRate;
+        if ((int)fileRate != rate) {
+            int inFrames = ir[0].size() + 64;
+            std::vector<dsp::Frame<2>> in(inFrames);
+            for (size_t f = 0; f < ir[0].size(); f++) {
+                in[f].samples[0] = ir[0][f];
+                in[f].samples[1] = ir[1][f];
+            }
+            for (int f = ir[0].size(); f < inFrames; f++) {
+                in[f].samples[0] = in[f].samples[1] = 0.f;
+            }
+
+            int maxOutFrames = (int)((int64_t)inFrames * rate / (int)fileRate) + 64;
+            std::vector<dsp::Frame<2>> out(maxOutFrames);
+            dsp::SampleRateConverter<2> converter;
+            converter.setChannels(2);
+            converter.setRates((int)fileRate, rate);
+
+            int inDone = 0;
+            int outDone = 0;
+            while (inDone < inFrames && outDone < maxOutFrames) {
+                int inCount = inFrames - inDone;
+                int outCount = maxOutFrames - outDone;
+                converter.process(&in[inDone], &inCount, &out[outDone], &outCount);
+                if (inCount == 0 && outCount == 0) {
+                    break;
+                }
+                inDone += inCount;
+                outDone += outCount;
+            }
+
+            int frames = std::min(outDone, (int)(REVERB_MAX_SECONDS * rate));
+            for (int c = 0; c < 2; c++) {
+                ir[c].resize(frames);
+                for (int f = 0; f < frames; f++) {
+                    ir[c][f] = out[f].samples[c];
+                }
+            }
+        }
+
+        // Normalize to unit energy on the louder channel
+        float energy = 0.f;
+        for (int c = 0; c < 2; c++) {
+            float sum = 0.f;
+            for (float v : ir[c]) {
+                sum += v * v;
+            }
+            energy = std::max(energy, sum);
+        }
+        if (energy <= 0.f) {
+            return NULL;
+        }
+        float norm = 1.f / std::sqrt(energy);
+        for (int c = 0; c < 2; c++) {
+            for (float &v : ir[c]) {
+                v *= norm;
+            }
+        }
+
+        return new ReverbEngine(ir);
+    }
+
+    /** Runs the tail blocks the audio thread posts, sleeping in between. */
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(workerMutex);
+        while (true) {
+            workerCv.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+                return !workerRunning || tailJob.load(std::memory_order_acquire);
+            });
+            if (!workerRunning) {
+                break;
+            }
+
+            ReverbEngine *job = tailJob.load(std::memory_order_acquire);
+            if (!job) {
+                continue;
+            }
+            lock.unlock();
+            job->processTail();
+            tailJob.store(NULL, std::memory_order_release);
+            lock.lock();
+        }
+    }
+
+    /** Builds engines for IR loads and frees retired ones, so the tail keeps playing during a swap. */
+    void loaderLoop() {
+        std::unique_lock<std::mutex> lock(loadMutex);
+        while (true) {
+            loaderCv.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+                return !workerRunning || loadRequested || retiredEngine.load();
+            });
+            if (!workerRunning) {
+                break;
+            }
+            if (!loadRequested && !retiredEngine.load()) {
+                continue;
+            }
+
+            bool load = false;
+            std::swap(load, loadRequested);
+            std::string path = irPath;
+            lock.unlock();
+
+            delete retiredEngine.exchange(NULL);
+            if (load) {
+                ReverbEngine *loaded = path.empty() ? NULL : buildEngine(path);
+                // Unloading swaps in an empty engine
+                if (!loaded) {
+                    std::vector<float> silence[2];
+                    loaded = new ReverbEngine(silence);
+                }
+                delete pendingEngine.exchange(loaded);
+            }
+            lock.lock();
+        }
+    }
+
+    /** Collects the worker's last tail block and posts the next one, at each tail block boundary. */
+    void handOffTail(ReverbEngine *e) {
+        std::memcpy(e->tailPrevious, e->tailOutput, sizeof(e->tailOutput));
+
+        if (tailJob.load(std::memory_order_acquire)) {
+            // The worker is late, drop this block and keep the tail silent until it catches up
+            std::memset(e->tailOutput, 0, sizeof(e->tailOutput));
+            e->lateBlocks++;
+            e->jobLate = true;
+            return;
+        }
+
+        if (e->jobReady && !e->jobLate) {
+            std::memcpy(e->tailOutput, e->jobOutput, sizeof(e->tailOutput));
+        } else {
+            std::memset(e->tailOutput, 0, sizeof(e->tailOutput));
+        }
+        e->jobLate = false;
+
+        std::memcpy(e->jobInput, e->tailInput, sizeof(e->jobInput));
+        e->jobSkipped = e->lateBlocks;
+        e->lateBlocks = 0;
+        tailJob.store(e, std::memory_order_release);
+        workerCv.notify_one();
+    }
+
+    void process(const ProcessArgs &args) override {
+        float daisySignals_l[16] = {};
+        float daisySignals_r[16] = {};
+        int chainChannels = 1;
+        DaisyChainState chainState;
+        DaisyReturnMessage returnMessage;
+        float send[2] = {};
+        bool sendFromChain = false;
+
+        // Get daisy-chained data from left-side linked module
+        if (leftExpander.module && (
+            leftExpander.module->model == modelDaisyChannel2
+            || leftExpander.module->model == modelDaisyChannelVu
+            || leftExpander.module->model == modelDaisyChannelSends2
+            || leftExpander.module->model == modelDaisyChannelSends3
+            || leftExpander.module->model == modelDaisyBlank1
+            || leftExpander.module->model == modelDaisyBlank2
+            || leftExpander.module->model == modelDaisyChannelDynamics
+            || leftExpander.module->model == modelDaisyAnalyzer
+            || leftExpander.module->model == modelDaisyReverb
+            || leftExpander.module->model == modelDaisyMatrix
+        )) {
+            DaisyMessage *msgFromModule = (DaisyMessage *)(leftExpander.consumerMessage);
+            chainChannels = msgFromModule->channels;
+            chainState = msgFromModule->chain;
+            for (int c = 0; c < chainChannels; c++) {
+                daisySignals_l[c] = msgFromModule->voltages_l[c];
+                daisySignals_r[c] = msgFromModule->voltages_r[c];
+            }
+
+            // An aux send on the left feeds its aux bus in, unless the inputs are patched
+            if (leftExpander.module->model == modelDaisyChannelSends2
+                || leftExpander.module->model == modelDaisyChannelSends3) {
+                for (int c = 0; c < msgFromModule->single_channels; c++) {
+                    send[0] += msgFromModule->single_voltages_l[c];
+                    send[1] += msgFromModule->single_voltages_r[c];
+                }
+                sendFromChain = true;
+            }
+
+            link_l = 0.8f;
+        } else {
+            link_l = 0.0f;
+        }
+
+        if (inputs[IN_INPUT_1].isConnected() || !sendFromChain) {
+            send[0] = inputs[IN_INPUT_1].getVoltageSum();
+            send[1] = inputs[IN_INPUT_2].isConnected() ? inputs[IN_INPUT_2].getVoltageSum() : send[0];
+        }
+
+        // Swap in a newly loaded IR, once the worker is done with the old one
+        if (pendingEngine.load() && !retiredEngine.load() && !tailJob.load(std::memory_order_acquire)) {
+            retiredEngine.store(engine);
+            engine = pendingEngine.exchange(NULL);
+            loaderCv.notify_one();
+        }
+
+        float wet[2] = {};
+        if (engine && engine->loaded) {
+            if (engine->process(send, wet)) {
+                handOffTail(engine);
+            }
+            float gain = params[RETURN_LVL_PARAM].getValue();
+            gain *= gain;
+            wet[0] *= gain;
+            wet[1] *= gain;
+        }
+
+        outputs[WET_OUTPUT_1].setVoltage(wet[0]);
+        outputs[WET_OUTPUT_2].setVoltage(wet[1]);
+
+        // Set daisy-chained output to right-side linked module
+        if (rightExpander.module && (
+            rightExpander.module->model == modelDaisyMaster2
+            || rightExpander.module->model == modelDaisyChannel2
+            || rightExpander.module->model == modelDaisyChannelVu
+            || rightExpander.module->model == modelDaisyChannelSends2
+            || rightExpander.module->model == modelDaisyChannelSends3
+            || rightExpander.module->model == modelDaisyBlank1
+            || rightExpander.module->model == modelDaisyBlank2
+            || rightExpander.module->model == modelDaisyChannelDynamics
+            || rightExpander.module->model == modelDaisyAnalyzer
+            || rightExpander.module->model == modelDaisyReverb
+            || rightExpander.module->model == modelDaisyMatrix
+        )) {
+            DaisyMessage *msgToModule = (DaisyMessage *)(rightExpander.module->leftExpander.producerMessage);
+
+            msgToModule->channels = chainChannels;
+            msgToModule->chain = chainState;
+            daisyRelayCue(chainState, (DaisyMessage *)(leftExpander.consumerMessage), msgToModule);
+
+            // Get the return message coming back from the master
+            returnMessage = *(DaisyReturnMessage *)(rightExpander.consumerMessage);
+
+            // The return is a stereo contribution, mixed into the first voice
+            daisySignals_l[0] += wet[0];
+            daisySignals_r[0] += wet[1];
+            for (int c = 0; c < chainChannels; c++) {
+                msgToModule->voltages_l[c] = daisySignals_l[c];
+                msgToModule->voltages_r[c] = daisySignals_r[c];
+            }
+
+            // Write this module's output to the producer message, if the right-side module reads it
+            if (returnMessage.needs_single) {
+                msgToModule->single_channels = 1;
+                msgToModule->single_voltages_l[0] = wet[0];
+                msgToModule->single_voltages_r[0] = wet[1];
+            }
+
+            rightExpander.module->leftExpander.messageFlipRequested = true;
+
+            link_r = 0.8f;
+        } else {
+            link_r = 0.0f;
+        }
+
+        // Pass the return message on to the left-side linked module, asking a sends module for its aux feed
+        if (link_l > 0.f) {
+            DaisyReturnMessage *returnToModule = (DaisyReturnMessage *)(leftExpander.module->rightExpander.producerMessage);
+            *returnToModule = returnMessage;
+            returnToModule->needs_single = sendFromChain && !inputs[IN_INPUT_1].isConnected();
+            returnToModule->needs_aux = returnToModule->needs_single;
+            leftExpander.module->rightExpander.messageFlipRequested = true;
+        }
+
+        // Set lights
+        if (lightDivider.process()) {
+            daisyGovernLights(lightDivider, args);
+            lights[IR_LIGHT].setBrightness(engine && engine->loaded);
+            lights[LINK_LIGHT_L].setBrightness(link_l);
+            lights[LINK_LIGHT_R].setBrightness(link_r);
+        }
+    }
+};
+
+struct DaisyReverbWidget : ModuleWidget {
+    DaisyReverbWidget(DaisyReverb *module) {
+        setModule(module);
+        setPanel(createPanel(asset::plugin(pluginInstance, "res/DaisyReverb.svg"), asset::plugin(pluginInstance, "res/DaisyReverb-dark.svg")));
+
+        // Screws
+        addChild(createWidget<ThemedScrew>(Vec(RACK_GRID_WIDTH, 0)));
+        addChild(createWidget<ThemedScrew>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+
+        // IR light & return level
+        addChild(createLightCentered<SmallLight<GreenLight>>(Vec(box.size.x / 2 + 7, 41.2), module, DaisyReverb::IR_LIGHT));
+        addParam(createParam<RoundLargeBlackKnob>(Vec(box.size.x / 2 - (36.0 / 2), 60.0), module, DaisyReverb::RETURN_LVL_PARAM));
+
+        // Send inputs
+        addInput(createInput<ThemedPJ301MPort>(Vec(box.size.x / 2 - 12.5, 118.0), module, DaisyReverb::IN_INPUT_1));
+        addInput(createInput<ThemedPJ301MPort>(Vec(box.size.x / 2 - 12.5, 144.0), module, DaisyReverb::IN_INPUT_2));
+
+        // Wet outputs
+        addOutput(createOutput<ThemedPJ301MPort>(Vec(box.size.x / 2 - 12.5, 290.0), module, DaisyReverb::WET_OUTPUT_1));
+        addOutput(createOutput<ThemedPJ301MPort>(Vec(box.size.x / 2 - 12.5, 316.0), module, DaisyReverb::WET_OUTPUT_2));
+
+        // Link lights
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(box.size.x / 2 - 4, 361.0f), module, DaisyReverb::LINK_LIGHT_L));
+        addChild(createLightCentered<TinyLight<YellowLight>>(Vec(box.size.x / 2 + 4, 361.0f), module, DaisyReverb::LINK_LIGHT_R));
+    }
+
+    void appendContextMenu(Menu *menu) override {
+        DaisyReverb *module = dynamic_cast<DaisyReverb *>(this->module);
+
+        menu->addChild(new MenuSeparator);
+        std::string name = module->getIrName();
+        menu->addChild(createMenuLabel(name.empty() ? "No IR loaded" : name));
+
+        menu->addChild(createMenuItem("Load IR...", "", [=]() {
+            osdialog_filters *filters = osdialog_filters_parse("WAV:wav");
+            char *pathC = osdialog_file(OSDIALOG_OPEN, NULL, NULL, filters);
+            osdialog_filters_free(filters);
+            if (!pathC) {
+                return;
+            }
+            module->loadIr(pathC);
+            std::free(pathC);
+        }));
+
+        menu->addChild(createMenuItem("Unload IR", "", [=]() {
+            module->loadIr("");
+        }, name.empty()));
+    }
+};
+
+Model *modelDaisyReverb = createModel<DaisyReverb, DaisyReverbWidget>("DaisyReverb");
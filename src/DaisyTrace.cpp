@@ -0,0 +1,115 @@
+#include "QuantalAudioExtendedMixer.hpp"
+#include "Daisy.hpp"
+#include "DaisyTrace.hpp"
+#include <osdialog.h>
+
+bool DaisyTraceWriter::start(const std::string &path, float sampleRate) {
+    stop();
+
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    DaisyTraceFileHeader fileHeader;
+    std::copy(DAISY_TRACE_MAGIC, DAISY_TRACE_MAGIC + 8, fileHeader.magic);
+    fileHeader.version = DAISY_TRACE_VERSION;
+    fileHeader.sampleRate = sampleRate;
+    std::fwrite(&fileHeader, sizeof(fileHeader), 1, file);
+
+    this->path = path;
+    sequence = 0;
+    dropped = 0;
+
+    // Records still queued from an earlier session are skipped by the worker
+    int currentSession = session + 1;
+    session = currentSession;
+    workerRunning = true;
+    worker = std::thread([this, file, currentSession]() {
+        workerLoop(file, currentSession);
+    });
+    recording = true;
+    return true;
+}
+
+void DaisyTraceWriter::stop() {
+    recording = false;
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            workerRunning = false;
+        }
+        workerCv.notify_one();
+        worker.join();
+    }
+}
+
+void DaisyTraceWriter::workerLoop(FILE *file, int currentSession) {
+    while (true) {
+        bool running;
+        {
+            std::unique_lock<std::mutex> lock(workerMutex);
+            workerCv.wait_for(lock, std::chrono::milliseconds(5), [this]() {
+                return !workerRunning;
+            });
+            running = workerRunning;
+        }
+
+        while (!records.empty()) {
+            Record record = records.shift();
+            if (record.session != currentSession) {
+                continue;
+            }
+            int floats = 2 * (record.header.channels + record.header.single_channels);
+            std::fwrite(&record.header, sizeof(record.header), 1, file);
+            std::fwrite(record.voltages, sizeof(float), floats, file);
+        }
+
+        if (!running) {
+            break;
+        }
+    }
+    std::fclose(file);
+}
+
+bool DaisyTraceCapture::start(const std::string &path, float sampleRate) {
+    DaisyTraceWriter *w = writer.load();
+    if (!w) {
+        w = new DaisyTraceWriter;
+        writer.store(w, std::memory_order_release);
+    }
+    return w->start(path, sampleRate);
+}
+
+void DaisyTraceCapture::stop() {
+    DaisyTraceWriter *w = writer.load();
+    if (w) {
+        w->stop();
+    }
+}
+
+void daisyAppendTraceMenu(Menu *menu, DaisyTraceCapture *capture) {
+    menu->addChild(new MenuSeparator);
+    menu->addChild(createMenuLabel("Chain trace"));
+
+    if (capture->isTracing()) {
+        DaisyTraceWriter *writer = capture->writer;
+        menu->addChild(createMenuLabel(string::f("Capturing to %s, %llu dropped",
+            system::getFilename(writer->path).c_str(), (unsigned long long)writer->dropped)));
+        menu->addChild(createMenuItem("Stop capture", "", [=]() {
+            capture->stop();
+        }));
+    } else {
+        menu->addChild(createMenuItem("Capture trace...", "", [=]() {
+            osdialog_filters *filters = osdialog_filters_parse("Daisy trace:daisytrace");
+            char *pathC = osdialog_file(OSDIALOG_SAVE, NULL, "chain.daisytrace", filters);
+            osdialog_filters_free(filters);
+            if (!pathC) {
+                return;
+            }
+            if (!capture->start(pathC, APP->engine->getSampleRate())) {
+                osdialog_message(OSDIALOG_WARNING, OSDIALOG_OK, "Could not create the trace file.");
+            }
+            std::free(pathC);
+        }));
+    }
+}
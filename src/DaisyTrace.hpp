@@ -0,0 +1,133 @@
+#if !defined(DAISY_TRACE_H)
+#define DAISY_TRACE_H 1
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*
+ * Chain message traces, for reproducing a patch's chain traffic offline.
+ *
+ * A trace is a DaisyTraceFileHeader followed by one record per captured
+ * sample: a DaisyTraceRecordHeader, then channels floats of left and of
+ * right chain voltages, then single_channels floats of left and of right
+ * single voltages. Values are in native byte order. Gaps in the sequence
+ * numbers are samples the writer had to drop.
+ */
+
+const char DAISY_TRACE_MAGIC[8] = {'D', 'A', 'I', 'S', 'Y', 'T', 'R', 'C'};
+const uint32_t DAISY_TRACE_VERSION = 1;
+
+struct DaisyTraceFileHeader {
+    char magic[8];
+    uint32_t version;
+    float sampleRate;
+};
+
+struct DaisyTraceRecordHeader {
+    // Counts every sample offered to the writer, written or dropped
+    uint64_t sequence;
+    // Engine frame the message arrived on
+    int64_t frame;
+    uint8_t channels;
+    uint8_t single_channels;
+    uint16_t reserved;
+    uint32_t reserved2;
+};
+
+/**
+ * Writes the messages a module receives to a trace file. The audio thread
+ * copies each message into a ring buffer and never blocks; a worker drains
+ * the ring to disk. Start and stop from the UI thread.
+ */
+struct DaisyTraceWriter {
+    struct Record {
+        DaisyTraceRecordHeader header;
+        int session;
+        float voltages[64];
+    };
+
+    std::atomic<bool> recording {false};
+    std::atomic<int> session {0};
+    uint64_t sequence = 0;
+    uint64_t dropped = 0;
+    dsp::RingBuffer<Record, 8192> records;
+
+    std::string path;
+    std::thread worker;
+    std::atomic<bool> workerRunning {false};
+    std::mutex workerMutex;
+    std::condition_variable workerCv;
+
+    ~DaisyTraceWriter() {
+        stop();
+    }
+
+    /** Opens the trace file and starts the worker, returns false if the file can't be created. */
+    bool start(const std::string &path, float sampleRate);
+
+    /** Stops recording, writes out what is left in the ring and closes the file. */
+    void stop();
+
+    /** Queues one received message, from the audio thread. */
+    void push(const DaisyMessage &message, int64_t frame) {
+        Record record;
+        record.header.sequence = sequence++;
+        record.header.frame = frame;
+        record.header.channels = clamp(message.channels, 0, 16);
+        record.header.single_channels = clamp(message.single_channels, 0, 16);
+        record.header.reserved = 0;
+        record.header.reserved2 = 0;
+        record.session = session.load(std::memory_order_relaxed);
+
+        int n = record.header.channels;
+        int s = record.header.single_channels;
+        std::copy(message.voltages_l, message.voltages_l + n, record.voltages);
+        std::copy(message.voltages_r, message.voltages_r + n, record.voltages + n);
+        std::copy(message.single_voltages_l, message.single_voltages_l + s, record.voltages + 2 * n);
+        std::copy(message.single_voltages_r, message.single_voltages_r + s, record.voltages + 2 * n + s);
+
+        if (records.full()) {
+            dropped++;
+            return;
+        }
+        records.push(record);
+    }
+
+private:
+    void workerLoop(FILE *file, int currentSession);
+};
+
+/**
+ * Trace capture for a module's context menu. The writer is created on the
+ * first capture; the audio thread only pushes while it is recording.
+ */
+struct DaisyTraceCapture {
+    std::atomic<DaisyTraceWriter *> writer {NULL};
+
+    ~DaisyTraceCapture() {
+        delete writer.load();
+    }
+
+    /** Starts writing the chain messages the module receives to a trace file, from the UI thread. */
+    bool start(const std::string &path, float sampleRate);
+
+    void stop();
+
+    bool isTracing() {
+        DaisyTraceWriter *w = writer.load(std::memory_order_acquire);
+        return w && w->recording;
+    }
+
+    /** Queues one received message while capturing, from the audio thread. */
+    void push(const DaisyMessage &message, int64_t frame) {
+        if (isTracing()) {
+            writer.load(std::memory_order_relaxed)->push(message, frame);
+        }
+    }
+};
+
+/** Adds the capture and stop items to a module's context menu. */
+void daisyAppendTraceMenu(Menu *menu, DaisyTraceCapture *capture);
+
+#endif
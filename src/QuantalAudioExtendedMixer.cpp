@@ -1,4 +1,6 @@
 #include "QuantalAudioExtendedMixer.hpp"
+#include "DaisyGovernor.hpp"
+#include "DaisyMath.hpp"
 
 Plugin *pluginInstance;
 
@@ -10,10 +12,27 @@ void init(Plugin *p) {
     p->addModel(modelDaisyChannelSends2);
     p->addModel(modelDaisyChannelSends3);
     p->addModel(modelDaisyChannelVu);
+    p->addModel(modelDaisyChannelDynamics);
+    p->addModel(modelDaisyAnalyzer);
+    p->addModel(modelDaisyReverb);
+    p->addModel(modelDaisyMatrix);
     p->addModel(modelDaisyBlank1);
     p->addModel(modelDaisyBlank2);
     p->addModel(modelDaisyMaster2);
 
+    daisyMathInit();
+
     // Any other pluginInstance initialization may go here.
     // As an alternative, consider lazy-loading assets and lookup tables when your module is created to reduce startup times of Rack.
 }
+
+// Plugin-wide settings, kept in Rack's settings.json
+extern "C" json_t *settingsToJson() {
+    json_t *rootJ = json_object();
+    json_object_set_new(rootJ, "governor", daisyGovernor.toJson());
+    return rootJ;
+}
+
+extern "C" void settingsFromJson(json_t *rootJ) {
+    daisyGovernor.fromJson(json_object_get(rootJ, "governor"));
+}
@@ -11,6 +11,10 @@ extern Model *modelDaisyChannel2;
 extern Model *modelDaisyChannelSends2;
 extern Model *modelDaisyChannelSends3;
 extern Model *modelDaisyChannelVu;
+extern Model *modelDaisyChannelDynamics;
+extern Model *modelDaisyAnalyzer;
+extern Model *modelDaisyReverb;
+extern Model *modelDaisyMatrix;
 extern Model *modelDaisyBlank1;
 extern Model *modelDaisyBlank2;
 extern Model *modelDaisyMaster2;
@@ -0,0 +1,234 @@
+// Reads chain traces captured from a Daisy Blank module, and replays them
+// through any chain module headless for profiling. Linux and Mac only.
+//
+//   daisytrace info <trace>
+//   daisytrace dump <trace>
+//   daisytrace replay <trace> <module slug> [passes]
+//
+// Build with `make tools` from the plugin directory.
+
+#include "../src/QuantalAudioExtendedMixer.hpp"
+#include "../src/Daisy.hpp"
+#include "../src/DaisyTrace.hpp"
+
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** A trace file mapped into memory, read one record at a time. */
+struct TraceReader {
+    const uint8_t *data = NULL;
+    size_t size = 0;
+    size_t offset = 0;
+    DaisyTraceFileHeader fileHeader;
+
+    ~TraceReader() {
+        if (data) {
+            munmap((void *)data, size);
+        }
+    }
+
+    bool open(const char *path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            std::fprintf(stderr, "Could not open %s\n", path);
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(DaisyTraceFileHeader)) {
+            std::fprintf(stderr, "%s is not a chain trace\n", path);
+            ::close(fd);
+            return false;
+        }
+        size = st.st_size;
+        void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            std::fprintf(stderr, "Could not map %s\n", path);
+            return false;
+        }
+        data = (const uint8_t *)mapped;
+
+        std::memcpy(&fileHeader, data, sizeof(fileHeader));
+        if (std::memcmp(fileHeader.magic, DAISY_TRACE_MAGIC, 8) != 0 || fileHeader.version != DAISY_TRACE_VERSION) {
+            std::fprintf(stderr, "%s is not a version %u chain trace\n", path, DAISY_TRACE_VERSION);
+            return false;
+        }
+        rewind();
+        return true;
+    }
+
+    void rewind() {
+        offset = sizeof(DaisyTraceFileHeader);
+    }
+
+    /** Decodes the next record into a message, false at the end of the trace or on a truncated record. */
+    bool next(DaisyTraceRecordHeader &header, DaisyMessage &message) {
+        if (offset + sizeof(header) > size) {
+            return false;
+        }
+        std::memcpy(&header, data + offset, sizeof(header));
+        int n = std::min((int)header.channels, 16);
+        int s = std::min((int)header.single_channels, 16);
+        size_t length = sizeof(header) + sizeof(float) * 2 * (header.channels + header.single_channels);
+        if (offset + length > size) {
+            return false;
+        }
+
+        const float *voltages = (const float *)(data + offset + sizeof(header));
+        message.channels = n;
+        std::memcpy(message.voltages_l, voltages, sizeof(float) * n);
+        std::memcpy(message.voltages_r, voltages + n, sizeof(float) * n);
+        message.single_channels = s;
+        std::memcpy(message.single_voltages_l, voltages + 2 * n, sizeof(float) * s);
+        std::memcpy(message.single_voltages_r, voltages + 2 * n + s, sizeof(float) * s);
+
+        offset += length;
+        return true;
+    }
+};
+
+static int info(TraceReader &reader) {
+    DaisyTraceRecordHeader header;
+    DaisyMessage message;
+    uint64_t records = 0;
+    uint64_t dropped = 0;
+    uint64_t lastSequence = 0;
+    int maxChannels = 0;
+    int64_t firstFrame = 0;
+    int64_t lastFrame = 0;
+
+    while (reader.next(header, message)) {
+        if (records == 0) {
+            firstFrame = header.frame;
+        } else {
+            dropped += header.sequence - lastSequence - 1;
+        }
+        lastSequence = header.sequence;
+        lastFrame = header.frame;
+        maxChannels = std::max(maxChannels, (int)header.channels);
+        records++;
+    }
+
+    std::printf("sample rate   %g Hz\n", reader.fileHeader.sampleRate);
+    std::printf("records       %llu\n", (unsigned long long)records);
+    std::printf("dropped       %llu\n", (unsigned long long)dropped);
+    std::printf("duration      %.3f s\n", records ? (lastFrame - firstFrame + 1) / reader.fileHeader.sampleRate : 0.f);
+    std::printf("max channels  %d\n", maxChannels);
+    if (reader.offset != reader.size) {
+        std::printf("truncated     %llu trailing bytes\n", (unsigned long long)(reader.size - reader.offset));
+    }
+    return 0;
+}
+
+static int dump(TraceReader &reader) {
+    DaisyTraceRecordHeader header;
+    DaisyMessage message;
+
+    // One line per record, chain voices then single voices, each as l/r pairs
+    std::printf("sequence,frame,channels,single_channels,voltages\n");
+    while (reader.next(header, message)) {
+        std::printf("%llu,%lld,%d,%d", (unsigned long long)header.sequence, (long long)header.frame, message.channels, message.single_channels);
+        for (int c = 0; c < message.channels; c++) {
+            std::printf(",%g/%g", message.voltages_l[c], message.voltages_r[c]);
+        }
+        for (int c = 0; c < message.single_channels; c++) {
+            std::printf(",%g/%g", message.single_voltages_l[c], message.single_voltages_r[c]);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+static Model *findModel(const char *slug) {
+    for (Model *model : pluginInstance->models) {
+        if (model->slug == slug) {
+            return model;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Replays the trace into the module's left expander consumer message, one
+ * record per process() call. Blanks stand in for its neighbours so the
+ * module sees a linked chain on both sides.
+ */
+static int replay(TraceReader &reader, const char *slug, int passes) {
+    rack::Context *context = new rack::Context;
+    rack::contextSet(context);
+    context->engine = new rack::engine::Engine;
+
+    Plugin *plugin = new Plugin;
+    plugin->slug = "QuantalAudioExtendedMixer";
+    init(plugin);
+
+    Model *model = findModel(slug);
+    if (!model) {
+        std::fprintf(stderr, "No module %s in this plugin\n", slug);
+        return 1;
+    }
+    Module *module = model->createModule();
+    Module *left = modelDaisyBlank1->createModule();
+    Module *right = modelDaisyBlank2->createModule();
+    module->leftExpander.module = left;
+    left->rightExpander.module = module;
+    if (model != modelDaisyMaster2) {
+        module->rightExpander.module = right;
+        right->leftExpander.module = module;
+    }
+
+    float sampleRate = reader.fileHeader.sampleRate;
+    Module::ProcessArgs args;
+    args.sampleRate = sampleRate;
+    args.sampleTime = 1.f / sampleRate;
+    args.frame = 0;
+
+    DaisyTraceRecordHeader header;
+    DaisyMessage *input = (DaisyMessage *)module->leftExpander.consumerMessage;
+    auto startTime = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        reader.rewind();
+        while (reader.next(header, *input)) {
+            module->process(args);
+            args.frame++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::printf("%s: %lld samples in %.3f s, %.1f ns per sample, %.1fx realtime\n",
+        slug, (long long)args.frame, seconds, 1e9 * seconds / std::max(args.frame, (int64_t)1),
+        args.frame / sampleRate / seconds);
+
+    delete module;
+    delete left;
+    delete right;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: daisytrace info|dump <trace>\n       daisytrace replay <trace> <module slug> [passes]\n");
+        return 1;
+    }
+
+    TraceReader reader;
+    if (!reader.open(argv[2])) {
+        return 1;
+    }
+
+    std::string command = argv[1];
+    if (command == "info") {
+        return info(reader);
+    }
+    if (command == "dump") {
+        return dump(reader);
+    }
+    if (command == "replay" && argc >= 4) {
+        return replay(reader, argv[3], argc >= 5 ? std::max(std::atoi(argv[4]), 1) : 1);
+    }
+    std::fprintf(stderr, "Unknown command %s\n", argv[1]);
+    return 1;
+}